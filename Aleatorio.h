@@ -0,0 +1,102 @@
+#ifndef ALEATORIO_H
+#define ALEATORIO_H
+
+#include <cstdint>
+#include <limits>
+
+using namespace std;
+
+// Generador xoshiro256** (Blackman y Vigna). Es pequeño (32 bytes de estado), rapido y cumple
+// los requisitos de UniformRandomBitGenerator, asi que tambien sirve con las distribuciones de <random>.
+// Cada instancia se identifica por una semilla de ejecucion y un numero de flujo: dos generadores
+// con la misma pareja producen la misma secuencia, y flujos distintos son independientes.
+class GeneradorAleatorio {
+   public:
+    typedef uint64_t result_type;
+
+    uint64_t estado[4];
+
+    explicit GeneradorAleatorio(uint64_t semilla = 0, uint64_t flujo = 0) { sembrar(semilla, flujo); }
+
+    void sembrar(uint64_t semilla, uint64_t flujo = 0) {
+        // splitmix64 sobre la semilla mezclada con el flujo para rellenar el estado
+        uint64_t x = semilla ^ mezclar(flujo + 0x632be59bd9b4e019ULL);
+        for (int k = 0; k < 4; ++k) {
+            x += 0x9e3779b97f4a7c15ULL;
+            estado[k] = mezclar(x);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return numeric_limits<uint64_t>::max(); }
+
+    result_type operator()() {
+        uint64_t resultado = rotar(estado[1] * 5, 7) * 9;
+        uint64_t t = estado[1] << 17;
+        estado[2] ^= estado[0];
+        estado[3] ^= estado[1];
+        estado[1] ^= estado[2];
+        estado[0] ^= estado[3];
+        estado[2] ^= t;
+        estado[3] = rotar(estado[3], 45);
+        return resultado;
+    }
+
+    // Real uniforme en [0, 1) con 53 bits de precision
+    double uniforme() { return static_cast<double>((*this)() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // Entero uniforme en [0, n) por multiplicacion (Lemire), sin divisiones
+    uint64_t entero(uint64_t n) {
+        uint64_t x = (*this)();
+        uint64_t m_hi = multiplicarAlto(x, n);
+        uint64_t m_lo = x * n;
+        if (m_lo < n) {
+            uint64_t umbral = (0 - n) % n;
+            while (m_lo < umbral) {
+                x = (*this)();
+                m_hi = multiplicarAlto(x, n);
+                m_lo = x * n;
+            }
+        }
+        return m_hi;
+    }
+
+    // Avanza 2^128 pasos: permite repartir una misma secuencia en tramos que no se solapan
+    void saltar() {
+        static const uint64_t SALTO[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                         0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        uint64_t s[4] = {0, 0, 0, 0};
+        for (int i = 0; i < 4; ++i) {
+            for (int b = 0; b < 64; ++b) {
+                if (SALTO[i] & (1ULL << b)) {
+                    for (int k = 0; k < 4; ++k) s[k] ^= estado[k];
+                }
+                (*this)();
+            }
+        }
+        for (int k = 0; k < 4; ++k) estado[k] = s[k];
+    }
+
+   private:
+    static uint64_t rotar(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    static uint64_t mezclar(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    static uint64_t multiplicarAlto(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+        uint64_t a_lo = a & 0xffffffffULL, a_hi = a >> 32;
+        uint64_t b_lo = b & 0xffffffffULL, b_hi = b >> 32;
+        uint64_t medio = a_hi * b_lo + ((a_lo * b_lo) >> 32);
+        uint64_t medio2 = a_lo * b_hi + (medio & 0xffffffffULL);
+        return a_hi * b_hi + (medio >> 32) + (medio2 >> 32);
+#endif
+    }
+};
+
+#endif /* ALEATORIO_H */
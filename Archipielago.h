@@ -0,0 +1,236 @@
+#ifndef ARCHIPIELAGO_H
+#define ARCHIPIELAGO_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+#include "Aleatorio.h"
+#include "Cultivacion.h"
+#include "Enjambre.h"
+#include "Luciernaga.h"
+#include "PoolHilos.h"
+
+// A donde emigran las mejores luciernagas de cada isla
+enum TopologiaMigracion {
+    MIGRACION_ANILLO,    // La isla k envia a la k + 1 (la ultima a la primera)
+    MIGRACION_ALEATORIA  // En cada migracion se sortea una permutacion sin puntos fijos
+};
+
+// Parametros propios de una isla; por defecto los de Enjambre
+struct ParametrosIsla {
+    double alfa = 0.05;
+    double beta0 = 1;
+    double gamma = 3.0;
+};
+
+// Modelo de islas: varios Enjambre independientes, cada uno con su semilla y sus parametros, que
+// avanzan en paralelo (una isla por tarea del pool) y cada intervaloMigracion iteraciones se
+// intercambian sus numMigrantes mejores luciernagas, que sustituyen a las peores del destino.
+//
+// Los buzones de migracion tienen doble buffer: en la epoca e cada isla escribe sus emigrantes en
+// el buffer e % 2 de su destino y lee los inmigrantes que le dejaron en el otro buffer durante la
+// epoca anterior. Cada buffer tiene un unico escritor por epoca y el final de paraCada separa las
+// epocas, asi que no hacen falta cerrojos. Como las islas no comparten nada mas, el resultado solo
+// depende de la semilla, no del numero de hilos.
+class Archipielago {
+   public:
+    int numIslas;
+    int luciernagasPorIsla;
+    int intervaloMigracion = 10;
+    int numMigrantes = 2;
+    TopologiaMigracion topologia = MIGRACION_ANILLO;
+    ModoActualizacion modoActualizacion = ACTUALIZACION_POR_PAREJA;
+    bool sincrono = false;  // Con actualizacion por pareja, iterarSincrono en vez de iterarSecuencial
+    uint64_t semilla;
+
+    // Opciones de Enjambre que inicializar copia en todas las islas
+    EstrategiaInicializacion estrategiaInicializacion = INICIALIZACION_FACTIBLE;
+    int vecinosAtraccion = 0;  // > 0: cada isla con ATRACCION_VECINOS y estas vecinas
+    double umbralAtractivo = 0.0;
+    bool contiguo = false;  // Posiciones de cada isla en una matriz contigua
+
+    vector<unique_ptr<Enjambre> > islas;
+    Luciernaga mejorLuciernaga;  // Mejor luciernaga vista en cualquier isla
+
+    Archipielago(int numIslas, int luciernagasPorIsla, int dimension, uint64_t semilla)
+        : numIslas(max(1, numIslas)), luciernagasPorIsla(luciernagasPorIsla), semilla(semilla), mejorLuciernaga(dimension) {
+        mejorLuciernaga.valorObjetivo = -1e300;
+        for (int k = 0; k < this->numIslas; ++k) {
+            GeneradorAleatorio generadorSemillas(semilla, FLUJO_ISLAS + k);
+            islas.push_back(unique_ptr<Enjambre>(new Enjambre(luciernagasPorIsla, dimension, generadorSemillas())));
+            islas.back()->modoActualizacion = modoActualizacion;
+        }
+    }
+
+    // Aplica parametros distintos a cada isla (uno por isla)
+    void fijarParametros(const vector<ParametrosIsla>& parametros) {
+        for (int k = 0; k < numIslas && k < static_cast<int>(parametros.size()); ++k) {
+            islas[k]->alfa = parametros[k].alfa;
+            islas[k]->beta0 = parametros[k].beta0;
+            islas[k]->gamma = parametros[k].gamma;
+        }
+    }
+
+    // Reparte gamma en progresion geometrica entre gamma/2 y 2*gamma, para que unas islas
+    // exploren mas (atraccion de mayor alcance) y otras refinen mas
+    static vector<ParametrosIsla> parametrosEscalonados(int numIslas, const ParametrosIsla& base) {
+        vector<ParametrosIsla> parametros(numIslas, base);
+        for (int k = 0; k < numIslas && numIslas > 1; ++k) {
+            double t = static_cast<double>(k) / (numIslas - 1);
+            parametros[k].gamma = base.gamma * pow(4.0, t) / 2.0;
+        }
+        return parametros;
+    }
+
+    void inicializar(int numeroCultivos, int meses, Cultivacion& cultivacion, PoolHilos& pool) {
+        for (int k = 0; k < numIslas; ++k) {
+            Enjambre& isla = *islas[k];
+            isla.modoActualizacion = modoActualizacion;
+            isla.estrategiaInicializacion = estrategiaInicializacion;
+            if (vecinosAtraccion > 0) {
+                isla.modoAtraccion = ATRACCION_VECINOS;
+                isla.vecinosAtraccion = vecinosAtraccion;
+            }
+            isla.umbralAtractivo = umbralAtractivo;
+        }
+        pool.paraCada(islas.size(), [&](size_t inicio, size_t fin, int) {
+            for (size_t k = inicio; k < fin; ++k) {
+                islas[k]->inicializarLuciernagas(numeroCultivos, meses, cultivacion);
+                islas[k]->inicializarValoresObjetivo(numeroCultivos, meses, cultivacion);
+                if (contiguo) islas[k]->activarAlmacenamientoContiguo();
+            }
+        });
+
+        int migrantes = min(numMigrantes, luciernagasPorIsla);
+        buzones.assign(2 * numIslas, vector<Luciernaga>());
+        for (size_t b = 0; b < buzones.size(); ++b) buzones[b].assign(migrantes, Luciernaga(islas[0]->dimension()));
+        recibidos.assign(2 * numIslas, 0);
+        ordenes.assign(numIslas, vector<size_t>(luciernagasPorIsla));
+        destinos.resize(numIslas);
+        iteracion = 0;
+        epoca = 0;
+        generadorTopologia = GeneradorAleatorio(semilla, FLUJO_TOPOLOGIA);
+        actualizarMejor();
+    }
+
+    // Avanza todas las islas 'iteraciones' iteraciones, migrando cada intervaloMigracion
+    void iterar(int iteraciones, int numeroCultivos, int meses, Cultivacion& cultivacion, PoolHilos& pool) {
+        int intervalo = max(1, intervaloMigracion);
+        while (iteraciones > 0) {
+            int pasos = min(intervalo, iteraciones);
+            prepararDestinos();
+            int primeraIteracion = iteracion;
+            int buffer = epoca % 2;
+
+            pool.paraCada(islas.size(), [&](size_t inicio, size_t fin, int) {
+                for (size_t k = inicio; k < fin; ++k) {
+                    Enjambre& isla = *islas[k];
+                    recibirInmigrantes(k, 1 - buffer, numeroCultivos, meses, cultivacion);
+                    for (int p = 0; p < pasos; ++p) {
+                        if (modoActualizacion == ACTUALIZACION_COMBINADA)
+                            isla.iterarCombinado(numeroCultivos, meses, cultivacion, poolIsla, primeraIteracion + p);
+                        else if (sincrono)
+                            isla.iterarSincrono(numeroCultivos, meses, cultivacion, poolIsla, primeraIteracion + p);
+                        else
+                            isla.iterarSecuencial(numeroCultivos, meses, cultivacion);
+                    }
+                    enviarEmigrantes(k, buffer);
+                }
+            });
+
+            iteracion += pasos;
+            ++epoca;
+            iteraciones -= pasos;
+            actualizarMejor();
+        }
+    }
+
+    unsigned long long evaluaciones() const {
+        unsigned long long total = 0;
+        for (int k = 0; k < numIslas; ++k) total += islas[k]->evaluaciones();
+        return total;
+    }
+
+   private:
+    static const uint64_t FLUJO_ISLAS = 6ULL << 60;
+    static const uint64_t FLUJO_TOPOLOGIA = 7ULL << 60;
+
+    // buzones[2 * destino + buffer]: emigrantes que recibe 'destino'; recibidos[...] cuantos hay
+    vector<vector<Luciernaga> > buzones;
+    vector<int> recibidos;
+    vector<vector<size_t> > ordenes;  // Memoria para ordenar cada isla por valor objetivo
+    vector<int> destinos;             // Destino de cada isla en la epoca en curso
+    GeneradorAleatorio generadorTopologia;
+    int iteracion = 0;
+    int epoca = 0;
+
+    // Las islas en modo combinado o sincrono avanzan en el hilo de su tarea, con un pool de un solo hilo
+    PoolHilos poolIsla{1};
+
+    void prepararDestinos() {
+        for (int k = 0; k < numIslas; ++k) destinos[k] = (k + 1) % numIslas;
+        if (topologia == MIGRACION_ALEATORIA && numIslas > 2) {
+            // Ciclo aleatorio sobre todas las islas (Sattolo): permutacion sin puntos fijos
+            vector<int>& ciclo = destinos;
+            for (int k = 0; k < numIslas; ++k) ciclo[k] = k;
+            for (int k = numIslas - 1; k > 0; --k) {
+                int j = static_cast<int>(generadorTopologia.entero(k));
+                swap(ciclo[k], ciclo[j]);
+            }
+        }
+    }
+
+    void recibirInmigrantes(size_t k, int buffer, int numeroCultivos, int meses, Cultivacion& cultivacion) {
+        int& cuenta = recibidos[2 * k + buffer];
+        if (cuenta == 0) return;
+        Enjambre& isla = *islas[k];
+        vector<size_t>& orden = ordenarPorValor(k);
+        // Los inmigrantes sustituyen a las peores luciernagas de la isla
+        for (int m = 0; m < cuenta; ++m) {
+            isla.reemplazarLuciernaga(orden[m], buzones[2 * k + buffer][m], numeroCultivos, meses, cultivacion);
+        }
+        cuenta = 0;
+    }
+
+    void enviarEmigrantes(size_t k, int buffer) {
+        int destino = destinos[k];
+        if (destino == static_cast<int>(k)) return;
+        Enjambre& isla = *islas[k];
+        vector<size_t>& orden = ordenarPorValor(k);
+        vector<Luciernaga>& buzon = buzones[2 * destino + buffer];
+        int migrantes = static_cast<int>(buzon.size());
+        for (int m = 0; m < migrantes; ++m) {
+            isla.copiarLuciernaga(orden[orden.size() - 1 - m], buzon[m]);
+        }
+        recibidos[2 * destino + buffer] = migrantes;
+    }
+
+    // Indices de la isla k de peor a mejor valor objetivo (a igual valor, por indice)
+    vector<size_t>& ordenarPorValor(size_t k) {
+        const vector<double>& valores = islas[k]->valoresObjetivo;
+        vector<size_t>& orden = ordenes[k];
+        orden.resize(valores.size());
+        for (size_t i = 0; i < orden.size(); ++i) orden[i] = i;
+        sort(orden.begin(), orden.end(), [&valores](size_t a, size_t b) {
+            return valores[a] != valores[b] ? valores[a] < valores[b] : a < b;
+        });
+        return orden;
+    }
+
+    // Reduccion final de cada epoca: la mejor luciernaga de todas las islas
+    void actualizarMejor() {
+        for (int k = 0; k < numIslas; ++k) {
+            size_t indice = islas[k]->indiceMejorLuciernaga();
+            if (islas[k]->valoresObjetivo[indice] > mejorLuciernaga.valorObjetivo) {
+                islas[k]->copiarLuciernaga(indice, mejorLuciernaga);
+            }
+        }
+    }
+};
+
+#endif /* ARCHIPIELAGO_H */
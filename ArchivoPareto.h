@@ -0,0 +1,199 @@
+#ifndef ARCHIVOPARETO_H
+#define ARCHIVOPARETO_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "Objetivos.h"
+
+// Archivo acotado de soluciones no dominadas: el frente de Pareto de todo lo evaluado, con a lo
+// sumo 'capacidad' puntos.
+//
+// Las entradas estan ordenadas por cosecha decreciente, asi que una insercion no recorre el
+// archivo entero dos veces: solo las que tienen al menos la cosecha de la nueva pueden dominarla
+// (se miran hasta encontrar una y se para), y solo las que tienen a lo sumo su cosecha pueden
+// quedar dominadas por ella (se retiran en una pasada de compactacion). Las posiciones se guardan
+// en huecos reutilizables, de modo que, una vez lleno, el archivo ya no pide memoria.
+//
+// Si el frente tiene mas puntos que la capacidad se descarta el de menor distancia de
+// agrupamiento (crowding distance de NSGA-II): el que mas cerca tiene a sus vecinos en los tres
+// objetivos. Los extremos de cada objetivo (el mejor y el peor valor) solo se descartan si no
+// queda ninguna entrada que no sea extremo, lo que puede pasar con menos de 6 puntos; entonces se
+// descarta la que es extremo de menos objetivos. Como lo descartado se olvida, mas tarde puede
+// entrar un punto que solo dominaba una posicion ya descartada.
+class ArchivoPareto {
+   public:
+    explicit ArchivoPareto(size_t capacidad = 100) : capacidad(max<size_t>(2, capacidad)) {
+        entradas.reserve(this->capacidad + 1);
+        posiciones.resize(this->capacidad + 1);
+        libres.reserve(this->capacidad + 1);
+        for (size_t h = posiciones.size(); h > 0; --h) libres.push_back(h - 1);
+        orden.reserve(this->capacidad + 1);
+        distancias.reserve(this->capacidad + 1);
+        extremos.reserve(this->capacidad + 1);
+    }
+
+    // Anade la posicion de n areas con objetivos 'o' si ningun punto del archivo la cubre, y
+    // retira los que ella domina. Devuelve true si queda en el archivo.
+    bool insertar(const Objetivos& o, const double* valores, size_t n) {
+        size_t finCandidatas = upper_bound(entradas.begin(), entradas.end(), o, [](const Objetivos& x, const Entrada& e) {
+                                   return x.cosecha > e.objetivos.cosecha;
+                               }) - entradas.begin();
+        for (size_t k = 0; k < finCandidatas; ++k) {
+            if (Objetivos::cubre(entradas[k].objetivos, o)) return false;
+        }
+
+        size_t inicioDominadas = lower_bound(entradas.begin(), entradas.end(), o, [](const Entrada& e, const Objetivos& x) {
+                                     return e.objetivos.cosecha > x.cosecha;
+                                 }) - entradas.begin();
+        size_t quedan = inicioDominadas;
+        for (size_t k = inicioDominadas; k < entradas.size(); ++k) {
+            if (Objetivos::domina(o, entradas[k].objetivos)) {
+                libres.push_back(entradas[k].hueco);
+                continue;
+            }
+            entradas[quedan++] = entradas[k];
+        }
+        entradas.resize(quedan);
+
+        Entrada nueva;
+        nueva.objetivos = o;
+        nueva.hueco = libres.back();
+        libres.pop_back();
+        posiciones[nueva.hueco].assign(valores, valores + n);
+        size_t lugar = lower_bound(entradas.begin(), entradas.end(), nueva, antes) - entradas.begin();
+        entradas.insert(entradas.begin() + lugar, nueva);
+        ++inserciones;
+
+        if (entradas.size() <= capacidad) return true;
+        size_t descartada = masAgrupada();
+        libres.push_back(entradas[descartada].hueco);
+        entradas.erase(entradas.begin() + descartada);
+        ++descartesPorCapacidad;
+        return descartada != lugar;
+    }
+
+    void limpiar() {
+        for (size_t k = 0; k < entradas.size(); ++k) libres.push_back(entradas[k].hueco);
+        entradas.clear();
+        inserciones = 0;
+        descartesPorCapacidad = 0;
+    }
+
+    size_t tamano() const { return entradas.size(); }
+
+    size_t capacidadMaxima() const { return capacidad; }
+
+    // Punto k del frente, por cosecha decreciente
+    const Objetivos& objetivos(size_t k) const { return entradas[k].objetivos; }
+
+    const vector<double>& solucion(size_t k) const { return posiciones[entradas[k].hueco]; }
+
+    // Puntos que entraron en el archivo y puntos descartados por falta de sitio desde limpiar()
+    unsigned long long insertados() const { return inserciones; }
+    unsigned long long descartados() const { return descartesPorCapacidad; }
+
+    // Escribe el frente en CSV: una fila por punto con sus objetivos y sus areas (cultivo + mes * cultivos)
+    void guardar(const string& ruta) const {
+        ofstream archivo(ruta.c_str());
+        if (!archivo) throw runtime_error("No se puede escribir el frente de Pareto en '" + ruta + "'");
+        archivo << "cosecha,agua,salinidad";
+        size_t dimension = entradas.empty() ? 0 : solucion(0).size();
+        for (size_t i = 0; i < dimension; ++i) archivo << ",x" << i;
+        archivo << "\n";
+        char numero[32];
+        for (size_t k = 0; k < entradas.size(); ++k) {
+            const Objetivos& o = entradas[k].objetivos;
+            snprintf(numero, sizeof(numero), "%.17g", o.cosecha);
+            archivo << numero;
+            snprintf(numero, sizeof(numero), "%.17g", o.agua);
+            archivo << ',' << numero;
+            snprintf(numero, sizeof(numero), "%.17g", o.salinidad);
+            archivo << ',' << numero;
+            const vector<double>& valores = solucion(k);
+            for (size_t i = 0; i < valores.size(); ++i) {
+                snprintf(numero, sizeof(numero), "%.17g", valores[i]);
+                archivo << ',' << numero;
+            }
+            archivo << "\n";
+        }
+        if (!archivo) throw runtime_error("Error al escribir el frente de Pareto en '" + ruta + "'");
+    }
+
+   private:
+    struct Entrada {
+        Objetivos objetivos;
+        size_t hueco;  // Indice en 'posiciones'
+    };
+
+    size_t capacidad;
+    vector<Entrada> entradas;          // Frente actual, por cosecha decreciente
+    vector<vector<double> > posiciones;  // capacidad + 1 huecos: cabe la nueva antes de recortar
+    vector<size_t> libres;             // Huecos sin usar
+    unsigned long long inserciones = 0;
+    unsigned long long descartesPorCapacidad = 0;
+
+    // Memoria de masAgrupada
+    vector<size_t> orden;
+    vector<double> distancias;
+    vector<int> extremos;  // Objetivos de los que cada entrada es el mejor o el peor valor
+
+    // Cosecha decreciente; a igual cosecha, menos agua y luego menos salinidad
+    static bool antes(const Entrada& a, const Entrada& b) {
+        if (a.objetivos.cosecha != b.objetivos.cosecha) return a.objetivos.cosecha > b.objetivos.cosecha;
+        if (a.objetivos.agua != b.objetivos.agua) return a.objetivos.agua < b.objetivos.agua;
+        return a.objetivos.salinidad < b.objetivos.salinidad;
+    }
+
+    // Indice de la entrada que se descarta: la que es extremo de menos objetivos y, entre ellas,
+    // la de menor distancia de agrupamiento. La cosecha ya esta ordenada; el agua y la salinidad
+    // se ordenan aparte, asi que el coste es O(n log n) por descarte.
+    size_t masAgrupada() {
+        size_t n = entradas.size();
+        distancias.assign(n, 0.0);
+        extremos.assign(n, 0);
+        double rango = entradas[0].objetivos.cosecha - entradas[n - 1].objetivos.cosecha;
+        if (rango > 0) {
+            ++extremos[0];
+            ++extremos[n - 1];
+            for (size_t k = 1; k + 1 < n; ++k)
+                distancias[k] += (entradas[k - 1].objetivos.cosecha - entradas[k + 1].objetivos.cosecha) / rango;
+        }
+        sumarDistancias(&Objetivos::agua);
+        sumarDistancias(&Objetivos::salinidad);
+        size_t descartada = 0;
+        for (size_t k = 1; k < n; ++k) {
+            if (extremos[k] < extremos[descartada] ||
+                (extremos[k] == extremos[descartada] && distancias[k] < distancias[descartada])) {
+                descartada = k;
+            }
+        }
+        return descartada;
+    }
+
+    // Un objetivo en el que todas las entradas valen lo mismo no tiene extremos ni separa a nadie
+    void sumarDistancias(double Objetivos::*objetivo) {
+        size_t n = entradas.size();
+        orden.resize(n);
+        for (size_t k = 0; k < n; ++k) orden[k] = k;
+        sort(orden.begin(), orden.end(), [&](size_t a, size_t b) {
+            return entradas[a].objetivos.*objetivo < entradas[b].objetivos.*objetivo;
+        });
+        double rango = entradas[orden[n - 1]].objetivos.*objetivo - entradas[orden[0]].objetivos.*objetivo;
+        if (rango <= 0) return;
+        ++extremos[orden[0]];
+        ++extremos[orden[n - 1]];
+        for (size_t k = 1; k + 1 < n; ++k) {
+            distancias[orden[k]] += (entradas[orden[k + 1]].objetivos.*objetivo - entradas[orden[k - 1]].objetivos.*objetivo) / rango;
+        }
+    }
+};
+
+#endif /* ARCHIVOPARETO_H */
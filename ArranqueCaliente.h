@@ -0,0 +1,115 @@
+#ifndef ARRANQUECALIENTE_H
+#define ARRANQUECALIENTE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "Luciernaga.h"
+#include "PuntoControl.h"
+#include "Serializacion.h"
+
+// Soluciones de una ejecucion anterior para arrancar en caliente otra sobre una instancia
+// parecida (por ejemplo con otra prevision de agua). Se leen de un punto de control (la mejor
+// luciernaga y toda la poblacion) o de un archivo de solucion, que solo tiene la mejor:
+//
+//   cultivos 5
+//   meses 8
+//   objetivo 12.5                               # informativo
+//   valores 0 0.25 0 0 0.1                      # una linea por mes, cultivos valores cada una
+//   valores ...
+//
+// El formato de texto sigue las reglas de Instancia: '#' empieza un comentario y los valores se
+// separan con espacios o comas. Los errores se informan con runtime_error.
+class ArranqueCaliente {
+   public:
+    // Soluciones de 'ruta' para un problema de numeroCultivos x meses, la mejor primero
+    static vector<Luciernaga> cargar(const string& ruta, int numeroCultivos, int meses) {
+        ArchivoMapeado archivo(ruta);
+        try {
+            LectorBinario lector(archivo.datos, archivo.tamano);
+            if (archivo.tamano >= 8 && lector.u64() == PuntoControl::MAGICO) {
+                LectorBinario completo(archivo.datos, archivo.tamano);
+                return PuntoControl::leerSoluciones(completo, numeroCultivos, meses);
+            }
+            istringstream texto(string(reinterpret_cast<const char*>(archivo.datos), archivo.tamano));
+            return vector<Luciernaga>(1, leerSolucion(texto, numeroCultivos, meses));
+        } catch (const runtime_error& e) {
+            throw runtime_error("Arranque en caliente '" + ruta + "': " + e.what());
+        }
+    }
+
+    static void guardarSolucion(const string& ruta, const Luciernaga& luciernaga, int numeroCultivos, int meses) {
+        ofstream archivo(ruta.c_str());
+        if (!archivo) throw runtime_error("No se puede escribir la solucion en '" + ruta + "'");
+        char numero[32];
+        snprintf(numero, sizeof(numero), "%.17g", luciernaga.valorObjetivo);
+        archivo << "cultivos " << numeroCultivos << "\nmeses " << meses << "\nobjetivo " << numero << "\n";
+        for (int mes = 0; mes < meses; ++mes) {
+            archivo << "valores";
+            for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+                snprintf(numero, sizeof(numero), "%.17g", luciernaga.valores[cultivo + numeroCultivos * mes]);
+                archivo << ' ' << numero;
+            }
+            archivo << "\n";
+        }
+        if (!archivo) throw runtime_error("Error al escribir la solucion en '" + ruta + "'");
+    }
+
+    static Luciernaga leerSolucion(istream& entrada, int numeroCultivos, int meses) {
+        int cultivosLeidos = 0;
+        int mesesLeidos = 0;
+        Luciernaga luciernaga(0);
+        string linea;
+        int numeroLinea = 0;
+        while (getline(entrada, linea)) {
+            ++numeroLinea;
+            size_t comentario = linea.find('#');
+            if (comentario != string::npos) linea.erase(comentario);
+            replace(linea.begin(), linea.end(), ',', ' ');
+
+            istringstream campos(linea);
+            string clave;
+            if (!(campos >> clave)) continue;
+            vector<double> valores;
+            string texto;
+            while (campos >> texto) {
+                char* fin = nullptr;
+                double valor = strtod(texto.c_str(), &fin);
+                if (*fin != '\0' || !std::isfinite(valor)) {
+                    throw runtime_error("linea " + to_string(numeroLinea) + ": valor no valido '" + texto + "'");
+                }
+                valores.push_back(valor);
+            }
+            if (clave == "valores") {
+                luciernaga.valores.insert(luciernaga.valores.end(), valores.begin(), valores.end());
+            } else if ((clave == "cultivos" || clave == "meses" || clave == "objetivo") && valores.size() == 1) {
+                if (clave == "cultivos") cultivosLeidos = static_cast<int>(valores[0]);
+                if (clave == "meses") mesesLeidos = static_cast<int>(valores[0]);
+                if (clave == "objetivo") luciernaga.valorObjetivo = valores[0];
+            } else {
+                throw runtime_error("linea " + to_string(numeroLinea) + ": clave desconocida '" + clave + "'");
+            }
+        }
+        if (cultivosLeidos != numeroCultivos || mesesLeidos != meses) {
+            throw runtime_error("la solucion es de " + to_string(cultivosLeidos) + " cultivos y " + to_string(mesesLeidos) +
+                                " meses, no de " + to_string(numeroCultivos) + "x" + to_string(meses));
+        }
+        if (luciernaga.valores.size() != static_cast<size_t>(numeroCultivos) * meses) {
+            throw runtime_error("'valores' tiene " + to_string(luciernaga.valores.size()) + " valores, se esperaban " +
+                                to_string(numeroCultivos * meses));
+        }
+        return luciernaga;
+    }
+};
+
+#endif /* ARRANQUECALIENTE_H */
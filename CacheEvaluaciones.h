@@ -0,0 +1,160 @@
+#ifndef CACHEEVALUACIONES_H
+#define CACHEEVALUACIONES_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+// Cache de valores objetivo de posiciones ya evaluadas. La clave es una huella de 64 bits de la
+// posicion cuantizada a 'resolucion' (cada area se redondea al multiplo mas cercano), asi que dos
+// posiciones casi iguales comparten entrada y valor; con resolucion 0 solo coinciden posiciones
+// identicas bit a bit. Solo se guarda la huella, no la posicion: dos posiciones distintas con la
+// misma huella se confundirian, con probabilidad despreciable (del orden de entradas / 2^64).
+//
+// La tabla tiene capacidad fija y esta repartida en franjas, cada una con su cerrojo, para que
+// varios hilos la usen a la vez sin esperarse salvo si coinciden en franja. Dentro de una franja
+// cada huella va a una cubeta de VIAS entradas ordenadas de mas a menos reciente; al llenarse se
+// descarta la menos reciente.
+class CacheEvaluaciones {
+   public:
+    static const size_t VIAS = 4;
+
+    struct Estadisticas {
+        unsigned long long aciertos = 0;
+        unsigned long long fallos = 0;
+        unsigned long long inserciones = 0;
+        unsigned long long reemplazos = 0;  // Inserciones que descartaron otra entrada
+
+        double tasaAciertos() const {
+            unsigned long long consultas = aciertos + fallos;
+            return consultas > 0 ? static_cast<double>(aciertos) / consultas : 0.0;
+        }
+    };
+
+    CacheEvaluaciones(size_t capacidad, double resolucion, size_t numFranjas = 64)
+        : resolucionCuantizacion(resolucion), inversaResolucion(resolucion > 0 ? 1.0 / resolucion : 0.0),
+          numFranjas(numFranjas > 0 ? numFranjas : 1), franjas(new Franja[this->numFranjas]) {
+        cubetasPorFranja = capacidad / (this->numFranjas * VIAS);
+        if (cubetasPorFranja == 0) cubetasPorFranja = 1;
+        for (size_t f = 0; f < this->numFranjas; ++f) franjas[f].entradas.assign(cubetasPorFranja * VIAS, Entrada());
+    }
+
+    double resolucion() const { return resolucionCuantizacion; }
+
+    size_t capacidad() const { return numFranjas * cubetasPorFranja * VIAS; }
+
+    // Huella de una posicion de n valores. Nunca es 0, que marca las entradas libres.
+    uint64_t huella(const double* valores, size_t n) const {
+        uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t clave;
+            if (inversaResolucion > 0) {
+                clave = static_cast<uint64_t>(static_cast<int64_t>(floor(valores[i] * inversaResolucion + 0.5)));
+            } else {
+                memcpy(&clave, &valores[i], sizeof(clave));
+            }
+            h = (h ^ clave) * 0xbf58476d1ce4e5b9ULL;
+            h ^= h >> 31;
+        }
+        // Mezcla final de splitmix64
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h != 0 ? h : 1;
+    }
+
+    // Si la huella esta en la cache deja su valor en 'valor' y devuelve true
+    bool buscar(uint64_t huella, double& valor) {
+        Franja& franja = franjaDe(huella);
+        lock_guard<mutex> cerrojo(franja.cerrojo);
+        Entrada* cubeta = cubetaDe(franja, huella);
+        for (size_t k = 0; k < VIAS; ++k) {
+            if (cubeta[k].huella != huella) continue;
+            valor = cubeta[k].valor;
+            subirAlFrente(cubeta, k);
+            ++franja.estadisticas.aciertos;
+            return true;
+        }
+        ++franja.estadisticas.fallos;
+        return false;
+    }
+
+    void guardar(uint64_t huella, double valor) {
+        Franja& franja = franjaDe(huella);
+        lock_guard<mutex> cerrojo(franja.cerrojo);
+        Entrada* cubeta = cubetaDe(franja, huella);
+        size_t k = 0;
+        while (k < VIAS - 1 && cubeta[k].huella != huella && cubeta[k].huella != 0) ++k;
+        if (cubeta[k].huella != huella) {
+            ++franja.estadisticas.inserciones;
+            if (cubeta[k].huella != 0) ++franja.estadisticas.reemplazos;
+        }
+        cubeta[k].huella = huella;
+        cubeta[k].valor = valor;
+        subirAlFrente(cubeta, k);
+    }
+
+    void limpiar() {
+        for (size_t f = 0; f < numFranjas; ++f) {
+            lock_guard<mutex> cerrojo(franjas[f].cerrojo);
+            fill(franjas[f].entradas.begin(), franjas[f].entradas.end(), Entrada());
+            franjas[f].estadisticas = Estadisticas();
+        }
+    }
+
+    Estadisticas estadisticas() const {
+        Estadisticas total;
+        for (size_t f = 0; f < numFranjas; ++f) {
+            lock_guard<mutex> cerrojo(franjas[f].cerrojo);
+            const Estadisticas& parcial = franjas[f].estadisticas;
+            total.aciertos += parcial.aciertos;
+            total.fallos += parcial.fallos;
+            total.inserciones += parcial.inserciones;
+            total.reemplazos += parcial.reemplazos;
+        }
+        return total;
+    }
+
+   private:
+    struct Entrada {
+        uint64_t huella = 0;  // 0: libre
+        double valor = 0.0;
+    };
+
+    // Con relleno, como los indices de ColaSpsc, para que franjas contiguas no compartan linea de cache
+    struct Franja {
+        mutable mutex cerrojo;
+        vector<Entrada> entradas;
+        Estadisticas estadisticas;
+        char relleno[64];
+    };
+
+    double resolucionCuantizacion;
+    double inversaResolucion;
+    size_t numFranjas;
+    size_t cubetasPorFranja = 1;
+    unique_ptr<Franja[]> franjas;
+
+    // La franja sale de los bits altos de la huella y la cubeta de los bajos
+    Franja& franjaDe(uint64_t huella) { return franjas[(huella >> 40) % numFranjas]; }
+
+    Entrada* cubetaDe(Franja& franja, uint64_t huella) { return &franja.entradas[(huella % cubetasPorFranja) * VIAS]; }
+
+    // Lleva la entrada k al frente de la cubeta, desplazando las mas recientes que ella
+    static void subirAlFrente(Entrada* cubeta, size_t k) {
+        Entrada entrada = cubeta[k];
+        for (; k > 0; --k) cubeta[k] = cubeta[k - 1];
+        cubeta[0] = entrada;
+    }
+};
+
+#endif /* CACHEEVALUACIONES_H */
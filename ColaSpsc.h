@@ -0,0 +1,61 @@
+#ifndef COLASPSC_H
+#define COLASPSC_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// Cola circular de capacidad fija para un unico productor y un unico consumidor, sin cerrojos.
+// Cada extremo solo escribe su propio indice (con release) y lee el del otro (con acquire), asi
+// que meter y sacar no esperan nunca: si la cola esta llena, intentarMeter devuelve false.
+// La memoria se reserva al construirla; meter y sacar copian elementos sin pedir mas.
+template <class T>
+class ColaSpsc {
+   public:
+    // La capacidad se redondea a la siguiente potencia de dos
+    explicit ColaSpsc(size_t capacidad) {
+        size_t tamano = 2;
+        while (tamano < capacidad) tamano *= 2;
+        elementos.resize(tamano);
+        mascara = tamano - 1;
+    }
+
+    ColaSpsc(const ColaSpsc&) = delete;
+    ColaSpsc& operator=(const ColaSpsc&) = delete;
+
+    // Solo desde el hilo productor
+    bool intentarMeter(const T& elemento) {
+        size_t posicion = cola.load(memory_order_relaxed);
+        if (posicion - cabeza.load(memory_order_acquire) > mascara) return false;
+        elementos[posicion & mascara] = elemento;
+        cola.store(posicion + 1, memory_order_release);
+        return true;
+    }
+
+    // Solo desde el hilo consumidor
+    bool intentarSacar(T& elemento) {
+        size_t posicion = cabeza.load(memory_order_relaxed);
+        if (posicion == cola.load(memory_order_acquire)) return false;
+        elemento = elementos[posicion & mascara];
+        cabeza.store(posicion + 1, memory_order_release);
+        return true;
+    }
+
+    size_t capacidad() const { return mascara + 1; }
+
+   private:
+    vector<T> elementos;
+    size_t mascara;
+    // Relleno para que cada indice quede en su propia linea de cache y productor y consumidor no
+    // se estorben. Es relleno y no alignas porque la cola puede acabar en memoria dinamica, y en
+    // C++11 new no respeta alineaciones mayores que la de max_align_t.
+    char rellenoCabeza[64];
+    atomic<size_t> cabeza{0};  // Siguiente elemento a sacar
+    char rellenoCola[64 - sizeof(atomic<size_t>)];
+    atomic<size_t> cola{0};    // Siguiente hueco a llenar
+    char rellenoFinal[64 - sizeof(atomic<size_t>)];
+};
+
+#endif /* COLASPSC_H */
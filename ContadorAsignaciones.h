@@ -0,0 +1,49 @@
+#ifndef CONTADORASIGNACIONES_H
+#define CONTADORASIGNACIONES_H
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+// Cuenta todas las llamadas a operator new del programa para comprobar que el bucle de
+// iteraciones no pide memoria. Solo se activa compilando con -DALGORITMOFA_CONTAR_ASIGNACIONES,
+// y este archivo debe incluirse en una unica unidad de traduccion (la del ejecutable), porque
+// reemplaza los operadores globales.
+class ContadorAsignaciones {
+   public:
+    static atomic<unsigned long>& total() {
+        static atomic<unsigned long> contador(0);
+        return contador;
+    }
+
+    static bool activo() {
+#ifdef ALGORITMOFA_CONTAR_ASIGNACIONES
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+#ifdef ALGORITMOFA_CONTAR_ASIGNACIONES
+void* operator new(size_t tamano) {
+    ++ContadorAsignaciones::total();
+    void* memoria = malloc(tamano ? tamano : 1);
+    if (!memoria) throw bad_alloc();
+    return memoria;
+}
+
+void* operator new[](size_t tamano) { return operator new(tamano); }
+
+void operator delete(void* memoria) noexcept { free(memoria); }
+
+void operator delete[](void* memoria) noexcept { free(memoria); }
+
+void operator delete(void* memoria, size_t) noexcept { free(memoria); }
+
+void operator delete[](void* memoria, size_t) noexcept { free(memoria); }
+#endif
+
+#endif /* CONTADORASIGNACIONES_H */
@@ -0,0 +1,85 @@
+#ifndef CRITERIOSPARADA_H
+#define CRITERIOSPARADA_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+// Por que termino una ejecucion
+enum MotivoParada {
+    PARADA_NINGUNA,        // Aun no ha terminado
+    PARADA_ITERACIONES,    // Se hicieron todas las iteraciones pedidas
+    PARADA_ESTANCAMIENTO,  // La mejor solucion no mejoro en ventanaEstancamiento iteraciones
+    PARADA_DIVERSIDAD,     // El enjambre se concentro por debajo de diversidadMinima
+    PARADA_TIEMPO,         // Se agoto segundosMaximos
+    PARADA_EVALUACIONES    // Se agotaron evaluacionesMaximas
+};
+
+// Criterios para terminar antes del numero fijo de iteraciones. Se pueden combinar; cada uno esta
+// desactivado con su valor por defecto (0). Se comprueban al final de cada iteracion, asi que los
+// presupuestos de tiempo y de evaluaciones se pueden pasar como mucho en una iteracion.
+class CriteriosParada {
+   public:
+    int iteracionesMaximas = 0;
+    int ventanaEstancamiento = 0;           // Iteraciones seguidas sin mejora que se toleran
+    double toleranciaEstancamiento = 0.0;   // Mejora relativa minima que cuenta como mejora
+    double diversidadMinima = 0.0;          // Distancia media al centroide por debajo de la cual se para
+    double segundosMaximos = 0.0;           // Desde que se crean los criterios, inicializacion incluida
+    unsigned long long evaluacionesMaximas = 0;
+
+    // Toma 'mejorValor' como referencia del estancamiento antes de la primera iteracion
+    void iniciar(int primeraIteracion, double mejorValor) {
+        iteracionMejora = primeraIteracion;
+        valorReferencia = mejorValor;
+    }
+
+    // Vuelve a contar segundosMaximos desde ahora, para reutilizar los criterios en otra ejecucion
+    void reiniciarReloj() { inicio = Reloj::now(); }
+
+    bool necesitaDiversidad() const { return diversidadMinima > 0; }
+
+    // Se llama tras completar 'iteracionesHechas' iteraciones. 'diversidad()' solo se evalua si
+    // hay criterio de diversidad, para no medir el enjambre cuando no hace falta.
+    template <class Diversidad>
+    MotivoParada comprobar(int iteracionesHechas, double mejorValor, unsigned long long evaluaciones, Diversidad diversidad) {
+        if (mejorValor - valorReferencia > toleranciaEstancamiento * max(1.0, fabs(valorReferencia))) {
+            valorReferencia = mejorValor;
+            iteracionMejora = iteracionesHechas;
+        }
+        if (iteracionesHechas >= iteracionesMaximas) return PARADA_ITERACIONES;
+        if (evaluacionesMaximas > 0 && evaluaciones >= evaluacionesMaximas) return PARADA_EVALUACIONES;
+        if (segundosMaximos > 0 && segundosTranscurridos() >= segundosMaximos) return PARADA_TIEMPO;
+        if (ventanaEstancamiento > 0 && iteracionesHechas - iteracionMejora >= ventanaEstancamiento) return PARADA_ESTANCAMIENTO;
+        if (necesitaDiversidad() && diversidad() < diversidadMinima) return PARADA_DIVERSIDAD;
+        return PARADA_NINGUNA;
+    }
+
+    double segundosTranscurridos() const { return chrono::duration<double>(Reloj::now() - inicio).count(); }
+
+    static const char* describir(MotivoParada motivo) {
+        switch (motivo) {
+            case PARADA_ITERACIONES:
+                return "iteraciones completadas";
+            case PARADA_ESTANCAMIENTO:
+                return "estancamiento";
+            case PARADA_DIVERSIDAD:
+                return "diversidad minima";
+            case PARADA_TIEMPO:
+                return "tiempo maximo";
+            case PARADA_EVALUACIONES:
+                return "evaluaciones maximas";
+            default:
+                return "ninguno";
+        }
+    }
+
+   private:
+    typedef chrono::steady_clock Reloj;
+    Reloj::time_point inicio = Reloj::now();
+    int iteracionMejora = 0;  // Ultima iteracion en la que mejoro la mejor solucion
+    double valorReferencia = 0.0;
+};
+
+#endif /* CRITERIOSPARADA_H */
@@ -0,0 +1,502 @@
+#ifndef DISTRIBUIDO_H
+#define DISTRIBUIDO_H
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ALGORITMOFA_SOCKETS_UNIX
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#include "Aleatorio.h"
+#include "CriteriosParada.h"
+#include "Enjambre.h"
+#include "Instancia.h"
+#include "Luciernaga.h"
+#include "PoolHilos.h"
+#include "Serializacion.h"
+
+// Modelo de islas repartido entre procesos de la misma maquina. Un coordinador escucha en un
+// socket Unix; cada trabajador se conecta, recibe la configuracion y la instancia, y ejecuta un
+// Enjambre propio. Cada intervaloMigracion iteraciones los trabajadores envian su elite al
+// coordinador, que la reenvia en anillo (el trabajador k recibe la del k - 1) y guarda la mejor
+// luciernaga global. El intercambio es sincrono por epocas, asi que el resultado solo depende de
+// la semilla y del numero de trabajadores (salvo si se para por tiempo). Los criterios de parada
+// los comprueba el coordinador entre epocas con la mejor luciernaga y las evaluaciones de todos.
+//
+// Protocolo: mensajes con cabecera de 8 bytes (tipo y longitud, uint32 little-endian) seguida de
+// la carga codificada con EscritorBinario.
+//   HOLA           trabajador -> coordinador  i32 identificador pedido (-1: cualquiera)
+//   CONFIGURACION  coordinador -> trabajador  u32 id, u32 trabajadores, u64 semilla, i32 luciernagas,
+//                                             i32 iteraciones, i32 intervalo, i32 migrantes,
+//                                             u32 combinada, texto de la instancia (formato de Instancia)
+//   ELITE          trabajador -> coordinador  u64 evaluaciones, u32 n, n luciernagas (la mejor primero)
+//   MIGRANTES      coordinador -> trabajador  u32 n, n luciernagas
+//   FIN            coordinador -> trabajador  sin carga: ultima epoca terminada
+enum TipoMensaje {
+    MENSAJE_HOLA = 1,
+    MENSAJE_CONFIGURACION = 2,
+    MENSAJE_ELITE = 3,
+    MENSAJE_MIGRANTES = 4,
+    MENSAJE_FIN = 5
+};
+
+// Parametros de una ejecucion distribuida que el coordinador comunica a los trabajadores
+struct ConfiguracionDistribuida {
+    uint64_t semilla = 0;
+    int luciernagas = 100;
+    int iteraciones = 100;
+    int intervaloMigracion = 10;
+    int migrantes = 2;
+    bool combinada = false;
+};
+
+#ifdef ALGORITMOFA_SOCKETS_UNIX
+
+// Conexion por la que se envian y reciben mensajes completos
+class CanalMensajes {
+   public:
+    static const uint32_t LONGITUD_MAXIMA = 1u << 30;
+
+    explicit CanalMensajes(int descriptor) : descriptor(descriptor) {}
+
+    ~CanalMensajes() {
+        if (descriptor >= 0) close(descriptor);
+    }
+
+    CanalMensajes(const CanalMensajes&) = delete;
+    CanalMensajes& operator=(const CanalMensajes&) = delete;
+
+    // Se conecta a un coordinador; reintenta durante 'segundos' por si aun no escucha
+    static unique_ptr<CanalMensajes> conectar(const string& ruta, double segundos = 10.0) {
+        sockaddr_un direccion = direccionSocket(ruta);
+        for (int intento = 0;; ++intento) {
+            int descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (descriptor < 0) throw runtime_error(string("socket: ") + strerror(errno));
+            if (connect(descriptor, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) == 0) {
+                return unique_ptr<CanalMensajes>(new CanalMensajes(descriptor));
+            }
+            int error = errno;
+            close(descriptor);
+            if (intento * 0.05 >= segundos) throw runtime_error("No se puede conectar a '" + ruta + "': " + strerror(error));
+            this_thread::sleep_for(chrono::milliseconds(50));
+        }
+    }
+
+    void enviar(uint32_t tipo, const vector<uint8_t>& datos) {
+        vector<uint8_t> cabecera;
+        EscritorBinario escritor(cabecera);
+        escritor.u32(tipo);
+        escritor.u32(static_cast<uint32_t>(datos.size()));
+        escribirTodo(cabecera.data(), cabecera.size());
+        escribirTodo(datos.data(), datos.size());
+    }
+
+    // Espera el siguiente mensaje; devuelve su tipo y deja la carga en 'datos'
+    uint32_t recibir(vector<uint8_t>& datos) {
+        uint8_t cabecera[8];
+        leerTodo(cabecera, sizeof(cabecera));
+        LectorBinario lector(cabecera, sizeof(cabecera));
+        uint32_t tipo = lector.u32();
+        uint32_t longitud = lector.u32();
+        if (longitud > LONGITUD_MAXIMA) throw runtime_error("Mensaje demasiado largo");
+        datos.resize(longitud);
+        leerTodo(datos.data(), longitud);
+        return tipo;
+    }
+
+    // Como recibir, pero exige un tipo concreto
+    void recibir(uint32_t tipoEsperado, vector<uint8_t>& datos) {
+        uint32_t tipo = recibir(datos);
+        if (tipo != tipoEsperado) {
+            throw runtime_error("Mensaje inesperado: tipo " + to_string(tipo) + " en lugar de " + to_string(tipoEsperado));
+        }
+    }
+
+    static sockaddr_un direccionSocket(const string& ruta) {
+        sockaddr_un direccion;
+        memset(&direccion, 0, sizeof(direccion));
+        direccion.sun_family = AF_UNIX;
+        if (ruta.size() >= sizeof(direccion.sun_path)) throw runtime_error("Ruta de socket demasiado larga: '" + ruta + "'");
+        strcpy(direccion.sun_path, ruta.c_str());
+        return direccion;
+    }
+
+   private:
+    int descriptor;
+
+    void escribirTodo(const uint8_t* datos, size_t tamano) {
+        while (tamano > 0) {
+            ssize_t escritos = send(descriptor, datos, tamano, MSG_NOSIGNAL);
+            if (escritos < 0 && errno == EINTR) continue;
+            if (escritos <= 0) throw runtime_error(string("Error al enviar: ") + strerror(errno));
+            datos += escritos;
+            tamano -= static_cast<size_t>(escritos);
+        }
+    }
+
+    void leerTodo(uint8_t* datos, size_t tamano) {
+        while (tamano > 0) {
+            ssize_t leidos = recv(descriptor, datos, tamano, 0);
+            if (leidos < 0 && errno == EINTR) continue;
+            if (leidos == 0) throw runtime_error("Conexion cerrada por el otro extremo");
+            if (leidos < 0) throw runtime_error(string("Error al recibir: ") + strerror(errno));
+            datos += leidos;
+            tamano -= static_cast<size_t>(leidos);
+        }
+    }
+};
+
+// Socket que escucha conexiones de trabajadores; borra el archivo del socket al destruirse
+class ServidorSocket {
+   public:
+    explicit ServidorSocket(const string& ruta) : ruta(ruta) {
+        sockaddr_un direccion = CanalMensajes::direccionSocket(ruta);
+        descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (descriptor < 0) throw runtime_error(string("socket: ") + strerror(errno));
+        unlink(ruta.c_str());
+        if (bind(descriptor, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0 || listen(descriptor, 64) != 0) {
+            int error = errno;
+            close(descriptor);
+            throw runtime_error("No se puede escuchar en '" + ruta + "': " + strerror(error));
+        }
+    }
+
+    ~ServidorSocket() {
+        close(descriptor);
+        unlink(ruta.c_str());
+    }
+
+    ServidorSocket(const ServidorSocket&) = delete;
+    ServidorSocket& operator=(const ServidorSocket&) = delete;
+
+    // Espera hasta 'milisegundos' a que haya una conexion pendiente; devuelve false si no llega
+    bool esperar(int milisegundos) {
+        pollfd espera;
+        espera.fd = descriptor;
+        espera.events = POLLIN;
+        espera.revents = 0;
+        int listos = poll(&espera, 1, milisegundos);
+        if (listos < 0 && errno != EINTR) throw runtime_error(string("poll: ") + strerror(errno));
+        return listos > 0;
+    }
+
+    unique_ptr<CanalMensajes> aceptar() {
+        while (true) {
+            int conexion = accept(descriptor, nullptr, nullptr);
+            if (conexion >= 0) return unique_ptr<CanalMensajes>(new CanalMensajes(conexion));
+            if (errno != EINTR) throw runtime_error(string("accept: ") + strerror(errno));
+        }
+    }
+
+   private:
+    string ruta;
+    int descriptor;
+};
+
+class Coordinador {
+   public:
+    Luciernaga mejorLuciernaga{0};
+    unsigned long long evaluaciones = 0;
+    MotivoParada motivo = PARADA_NINGUNA;
+    int iteracionesHechas = 0;
+
+    // Espera a numTrabajadores trabajadores en 'ruta' (si 'ejecutable' no esta vacio, los lanza
+    // el mismo como procesos hijos con --trabajador) y coordina la ejecucion hasta que se cumple
+    // alguno de 'criterios' (el de diversidad no se comprueba: el coordinador no ve los enjambres).
+    void ejecutar(int numTrabajadores, const string& ruta, const string& ejecutable,
+                  const ConfiguracionDistribuida& configuracion, const Instancia& instancia, CriteriosParada& criterios) {
+        ServidorSocket servidor(ruta);
+        vector<pid_t> hijos;
+        if (!ejecutable.empty()) {
+            for (int k = 0; k < numTrabajadores; ++k) hijos.push_back(lanzarTrabajador(ejecutable, ruta, k));
+        }
+
+        try {
+            coordinar(servidor, hijos, numTrabajadores, configuracion, instancia, criterios);
+        } catch (...) {
+            // Cerrar los canales despierta a los trabajadores que esperan un mensaje; la senal,
+            // a los que aun calculan o no se habian conectado
+            canales.clear();
+            terminarHijos(hijos);
+            esperarHijos(hijos);
+            throw;
+        }
+        esperarHijos(hijos);
+    }
+
+    // Segundos que se espera a que se conecten los trabajadores lanzados por el coordinador
+    static int segundosConexion() { return 30; }
+
+   private:
+    vector<unique_ptr<CanalMensajes> > canales;  // Indexados por identificador de trabajador
+
+    static const int MILISEGUNDOS_SONDEO = 100;
+
+    void coordinar(ServidorSocket& servidor, vector<pid_t>& hijos, int numTrabajadores,
+                   const ConfiguracionDistribuida& configuracion, const Instancia& instancia, CriteriosParada& criterios) {
+        // Aceptar a todos y asignarles identificador (el pedido si esta libre)
+        canales.clear();
+        canales.resize(numTrabajadores);
+        vector<unique_ptr<CanalMensajes> > sinIdentificador;
+        vector<uint8_t> datos;
+        for (int k = 0; k < numTrabajadores; ++k) {
+            unique_ptr<CanalMensajes> canal = aceptarTrabajador(servidor, hijos);
+            canal->recibir(MENSAJE_HOLA, datos);
+            int32_t pedido = LectorBinario(datos).i32();
+            if (pedido >= 0 && pedido < numTrabajadores && !canales[pedido])
+                canales[pedido] = move(canal);
+            else
+                sinIdentificador.push_back(move(canal));
+        }
+        for (int k = 0; k < numTrabajadores && !sinIdentificador.empty(); ++k) {
+            if (!canales[k]) {
+                canales[k] = move(sinIdentificador.back());
+                sinIdentificador.pop_back();
+            }
+        }
+
+        ostringstream textoInstancia;
+        instancia.escribir(textoInstancia);
+        for (int k = 0; k < numTrabajadores; ++k) {
+            datos.clear();
+            EscritorBinario escritor(datos);
+            escritor.u32(static_cast<uint32_t>(k));
+            escritor.u32(static_cast<uint32_t>(numTrabajadores));
+            escritor.u64(configuracion.semilla);
+            escritor.i32(configuracion.luciernagas);
+            escritor.i32(configuracion.iteraciones);
+            escritor.i32(configuracion.intervaloMigracion);
+            escritor.i32(configuracion.migrantes);
+            escritor.u32(configuracion.combinada ? 1 : 0);
+            escritor.texto(textoInstancia.str());
+            canales[k]->enviar(MENSAJE_CONFIGURACION, datos);
+        }
+
+        // Una vuelta por epoca: recoger las elites, comprobar los criterios y reenviarlas en anillo
+        int epocas = numeroEpocas(configuracion);
+        int intervalo = max(1, configuracion.intervaloMigracion);
+        vector<vector<uint8_t> > elites(numTrabajadores);
+        vector<unsigned long long> evaluacionesTrabajador(numTrabajadores, 0);
+        mejorLuciernaga.valorObjetivo = -1e300;
+        Luciernaga recibida(0);
+        motivo = PARADA_NINGUNA;
+        iteracionesHechas = 0;
+        for (int epoca = 0; epoca < epocas && motivo == PARADA_NINGUNA; ++epoca) {
+            for (int k = 0; k < numTrabajadores; ++k) {
+                canales[k]->recibir(MENSAJE_ELITE, datos);
+                LectorBinario lector(datos);
+                evaluacionesTrabajador[k] = lector.u64();
+                uint32_t cuenta = lector.u32();
+                // La carga de MIGRANTES es la de ELITE sin el contador de evaluaciones
+                elites[k].assign(datos.begin() + 8, datos.end());
+                if (cuenta > 0) {
+                    lector.luciernaga(recibida);
+                    if (recibida.valorObjetivo > mejorLuciernaga.valorObjetivo) mejorLuciernaga = recibida;
+                }
+            }
+            evaluaciones = 0;
+            for (int k = 0; k < numTrabajadores; ++k) evaluaciones += evaluacionesTrabajador[k];
+            // La mejor de la primera epoca es la referencia del estancamiento
+            if (epoca == 0) criterios.iniciar(0, mejorLuciernaga.valorObjetivo);
+            iteracionesHechas = min(configuracion.iteraciones, (epoca + 1) * intervalo);
+            motivo = criterios.comprobar(iteracionesHechas, mejorLuciernaga.valorObjetivo, evaluaciones,
+                                         []() { return numeric_limits<double>::infinity(); });
+            if (epoca == epocas - 1 && motivo == PARADA_NINGUNA) motivo = PARADA_ITERACIONES;
+            bool ultima = motivo != PARADA_NINGUNA;
+            for (int k = 0; k < numTrabajadores; ++k) {
+                if (ultima)
+                    canales[k]->enviar(MENSAJE_FIN, vector<uint8_t>());
+                else
+                    canales[k]->enviar(MENSAJE_MIGRANTES, elites[(k + numTrabajadores - 1) % numTrabajadores]);
+            }
+        }
+    }
+
+    // Acepta la siguiente conexion. Si el coordinador lanzo los trabajadores, falla cuando alguno
+    // termina antes de conectarse (por ejemplo, si no se pudo ejecutar) o si pasan
+    // segundosConexion(); los lanzados a mano (--sin-lanzar) se esperan sin limite.
+    unique_ptr<CanalMensajes> aceptarTrabajador(ServidorSocket& servidor, vector<pid_t>& hijos) {
+        chrono::steady_clock::time_point limite = chrono::steady_clock::now() + chrono::seconds(segundosConexion());
+        while (!servidor.esperar(MILISEGUNDOS_SONDEO)) {
+            if (hijos.empty()) continue;
+            comprobarHijos(hijos);
+            if (chrono::steady_clock::now() > limite) {
+                throw runtime_error("Los trabajadores no se han conectado en " + to_string(segundosConexion()) + " segundos");
+            }
+        }
+        return servidor.aceptar();
+    }
+
+    // Lanza un error si algun hijo ha terminado; los que terminan quedan recogidos (pid 0)
+    static void comprobarHijos(vector<pid_t>& hijos) {
+        for (size_t k = 0; k < hijos.size(); ++k) {
+            if (hijos[k] <= 0) continue;
+            int estado;
+            if (waitpid(hijos[k], &estado, WNOHANG) == hijos[k]) {
+                hijos[k] = 0;
+                throw runtime_error("El trabajador " + to_string(k) + " ha terminado antes de conectarse");
+            }
+        }
+    }
+
+    static void terminarHijos(const vector<pid_t>& hijos) {
+        for (size_t k = 0; k < hijos.size(); ++k) {
+            if (hijos[k] > 0) kill(hijos[k], SIGTERM);
+        }
+    }
+
+    static pid_t lanzarTrabajador(const string& ejecutable, const string& ruta, int identificador) {
+        pid_t pid = fork();
+        if (pid < 0) throw runtime_error(string("fork: ") + strerror(errno));
+        if (pid == 0) {
+            string id = to_string(identificador);
+            execl(ejecutable.c_str(), ejecutable.c_str(), "--trabajador", ruta.c_str(), "--id", id.c_str(),
+                  static_cast<char*>(nullptr));
+            cerr << "No se puede ejecutar '" << ejecutable << "': " << strerror(errno) << endl;
+            _exit(127);
+        }
+        return pid;
+    }
+
+    static void esperarHijos(const vector<pid_t>& hijos) {
+        for (size_t k = 0; k < hijos.size(); ++k) {
+            if (hijos[k] <= 0) continue;
+            int estado;
+            while (waitpid(hijos[k], &estado, 0) < 0 && errno == EINTR) {
+            }
+        }
+    }
+
+   public:
+    // Ruta del ejecutable en curso, para lanzar los trabajadores con el mismo binario
+    static string rutaEjecutable(const char* argv0) {
+        char ruta[4096];
+        ssize_t longitud = readlink("/proc/self/exe", ruta, sizeof(ruta) - 1);
+        if (longitud > 0) return string(ruta, static_cast<size_t>(longitud));
+        return argv0;
+    }
+
+    static int numeroEpocas(const ConfiguracionDistribuida& configuracion) {
+        int intervalo = max(1, configuracion.intervaloMigracion);
+        return max(1, (configuracion.iteraciones + intervalo - 1) / intervalo);
+    }
+};
+
+class Trabajador {
+   public:
+    // Se conecta al coordinador de 'ruta' y ejecuta su isla hasta recibir FIN
+    static void ejecutar(const string& ruta, int identificadorPedido) {
+        unique_ptr<CanalMensajes> canal = CanalMensajes::conectar(ruta);
+        vector<uint8_t> datos;
+        EscritorBinario(datos).i32(identificadorPedido);
+        canal->enviar(MENSAJE_HOLA, datos);
+
+        canal->recibir(MENSAJE_CONFIGURACION, datos);
+        LectorBinario lector(datos);
+        uint32_t identificador = lector.u32();
+        lector.u32();  // Numero de trabajadores: el anillo lo resuelve el coordinador
+        ConfiguracionDistribuida configuracion;
+        configuracion.semilla = lector.u64();
+        configuracion.luciernagas = lector.i32();
+        configuracion.iteraciones = lector.i32();
+        configuracion.intervaloMigracion = lector.i32();
+        configuracion.migrantes = lector.i32();
+        configuracion.combinada = lector.u32() != 0;
+        istringstream textoInstancia(lector.texto());
+        Instancia instancia = Instancia::leer(textoInstancia);
+        int nc = instancia.numeroCultivos;
+        int meses = instancia.meses;
+
+        // Misma derivacion de semillas que las islas de Archipielago
+        GeneradorAleatorio generadorSemillas(configuracion.semilla, FLUJO_TRABAJADORES + identificador);
+        Enjambre enjambre(configuracion.luciernagas, instancia.dimension(), generadorSemillas());
+        if (configuracion.combinada) enjambre.modoActualizacion = ACTUALIZACION_COMBINADA;
+        PoolHilos pool(1);
+        enjambre.inicializarLuciernagas(nc, meses, instancia.cultivacion);
+        enjambre.inicializarValoresObjetivo(nc, meses, instancia.cultivacion);
+
+        int migrantes = max(0, min(configuracion.migrantes, static_cast<int>(enjambre.luciernagas.size())));
+        int intervalo = max(1, configuracion.intervaloMigracion);
+        int restantes = configuracion.iteraciones;
+        int iteracion = 0;
+        vector<size_t> orden;
+        vector<Luciernaga> inmigrantes;
+        Luciernaga elite(instancia.dimension());
+
+        while (true) {
+            int pasos = min(intervalo, restantes);
+            for (int p = 0; p < pasos; ++p, ++iteracion) {
+                if (configuracion.combinada)
+                    enjambre.iterarCombinado(nc, meses, instancia.cultivacion, pool, iteracion);
+                else
+                    enjambre.iterarSecuencial(nc, meses, instancia.cultivacion);
+            }
+            restantes -= pasos;
+
+            // Enviar la elite, la mejor primero
+            ordenarPorValor(enjambre.valoresObjetivo, orden);
+            datos.clear();
+            EscritorBinario escritor(datos);
+            escritor.u64(enjambre.evaluaciones());
+            escritor.u32(static_cast<uint32_t>(migrantes));
+            for (int m = 0; m < migrantes; ++m) {
+                enjambre.copiarLuciernaga(orden[orden.size() - 1 - m], elite);
+                escritor.luciernaga(elite);
+            }
+            canal->enviar(MENSAJE_ELITE, datos);
+
+            if (canal->recibir(datos) == MENSAJE_FIN) break;
+
+            // Los inmigrantes sustituyen a las peores
+            LectorBinario lectorMigrantes(datos);
+            uint32_t cuenta = min<uint32_t>(lectorMigrantes.u32(), static_cast<uint32_t>(orden.size()));
+            inmigrantes.resize(cuenta, Luciernaga(0));
+            for (uint32_t m = 0; m < cuenta; ++m) {
+                lectorMigrantes.luciernaga(inmigrantes[m]);
+                if (inmigrantes[m].valores.size() != enjambre.dimension()) {
+                    throw runtime_error("Migrante de dimension " + to_string(inmigrantes[m].valores.size()) +
+                                        " en lugar de " + to_string(enjambre.dimension()));
+                }
+            }
+            for (uint32_t m = 0; m < cuenta; ++m) {
+                enjambre.reemplazarLuciernaga(orden[m], inmigrantes[m], nc, meses, instancia.cultivacion);
+            }
+        }
+    }
+
+   private:
+    static const uint64_t FLUJO_TRABAJADORES = 6ULL << 60;
+
+    // Indices de peor a mejor valor objetivo (a igual valor, por indice)
+    static void ordenarPorValor(const vector<double>& valores, vector<size_t>& orden) {
+        orden.resize(valores.size());
+        for (size_t i = 0; i < orden.size(); ++i) orden[i] = i;
+        sort(orden.begin(), orden.end(), [&valores](size_t a, size_t b) {
+            return valores[a] != valores[b] ? valores[a] < valores[b] : a < b;
+        });
+    }
+};
+
+#endif /* ALGORITMOFA_SOCKETS_UNIX */
+
+#endif /* DISTRIBUIDO_H */
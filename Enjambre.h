@@ -1,6 +1,7 @@
 #ifndef ENJAMBRE_H
 #define ENJAMBRE_H
 
+#include <cassert>
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
@@ -11,8 +12,29 @@
 
 using namespace std;
 
+#include "Aleatorio.h"
+#include "CacheEvaluaciones.h"
 #include "Cultivacion.h"
+#include "EspacioTrabajo.h"
+#include "EvaluadorLotes.h"
+#include "IndiceVecinos.h"
+#include "Instrumentacion.h"
+#include "KernelsSimd.h"
 #include "Luciernaga.h"
+#include "MatrizPosiciones.h"
+#include "ModeloProblema.h"
+#include "Objetivos.h"
+#include "PoolHilos.h"
+#include "RegistroDeshacer.h"
+#include "ReparacionFactibilidad.h"
+#include "TrayectoriaEvaluacion.h"
+#include "VistaLuciernaga.h"
+
+// Como se aplica la atraccion de las companeras mas brillantes
+enum ModoActualizacion {
+    ACTUALIZACION_POR_PAREJA,  // Un movimiento y una evaluacion por cada companera (algoritmo original)
+    ACTUALIZACION_COMBINADA    // Un unico desplazamiento acumulado, un movimiento aleatorio y una evaluacion
+};
 
 class Enjambre {
    public:
@@ -20,24 +42,97 @@ class Enjambre {
     double alfa = 0.05;
     double beta0 = 1;
     double gamma = 3.0;
+    uint64_t semilla = 0;
+    ModeloProblema modelo;         // Datos del problema precompilados (ver compilarModelo)
+    EstrategiaInicializacion estrategiaInicializacion = INICIALIZACION_FACTIBLE;
+
+    // Atraccion limitada: con ATRACCION_VECINOS cada luciernaga solo se compara con sus
+    // vecinosAtraccion vecinas mas cercanas (mas ella misma para el movimiento aleatorio).
+    // Con umbralAtractivo > 0 se ignoran las companeras cuyo atractivo queda por debajo.
+    ModoAtraccion modoAtraccion = ATRACCION_TODOS;
+    ModoActualizacion modoActualizacion = ACTUALIZACION_POR_PAREJA;
+    int vecinosAtraccion = 16;
+    double umbralAtractivo = 0.0;
+    // Con repararFactibilidad cada movimiento va seguido de ReparacionFactibilidad, que devuelve la
+    // posicion a las restricciones de area por mes y de periodo de crecimiento
+    bool repararFactibilidad = false;
+    // Cache opcional de valores objetivo, que puede compartirse entre hilos. Se anota cada posicion
+    // evaluada y un movimiento aleatorio que lleva a una posicion ya conocida como peor se revierte
+    // sin evaluarla. Con resolucion > 0 el valor conocido puede ser el de una posicion casi igual.
+    CacheEvaluaciones* cacheEvaluaciones = nullptr;
+    IndiceVecinos indiceVecinos;
+    vector<const double*> filasIndice;  // Filas indexadas en indiceVecinos
+    GeneradorAleatorio generador;  // Flujo principal, usado por la iteracion secuencial
     vector<Luciernaga> luciernagas;
-    vector<double> valoresObjetivo;
+    vector<double> valoresObjetivo;  // Valor objetivo vigente de cada luciernaga
+
+    // Almacenamiento contiguo opcional: con almacenamientoContiguo las posiciones vigentes estan en
+    // 'posiciones' y 'luciernagas' solo se actualiza al llamar a volcarPosiciones
+    bool almacenamientoContiguo = false;
+    MatrizPosiciones posiciones;
+
+    // Copia de la generacion anterior usada por la actualizacion sincrona
+    vector<Luciernaga> generacionAnterior;
+    MatrizPosiciones posicionesAnteriores;
+    vector<double> objetivosAnteriores;
+
+    // Trayectoria de la evaluacion de cada luciernaga, para reevaluar solo los meses cambiados
+    vector<TrayectoriaEvaluacion> trayectorias;
+
+    // Evaluaciones de la funcion objetivo hechas para cada luciernaga (completas o desde un mes).
+    // Cada entrada solo la toca el hilo que actualiza esa luciernaga; el total da evaluaciones().
+    vector<unsigned long> evaluacionesLuciernaga;
+    // Movimientos aleatorios que se mantuvieron o se revirtieron, con el mismo reparto por luciernaga
+    vector<unsigned long> movimientosAceptados;
+    vector<unsigned long> movimientosRevertidos;
+
+    // Memoria temporal de cada hilo de trabajo, reutilizada entre iteraciones
+    vector<EspacioTrabajo> espaciosTrabajo;
+
+    // Flujos de numeros aleatorios derivados de la semilla de la ejecucion
+    static const uint64_t FLUJO_INICIALIZACION = 1ULL << 62;
+    static const uint64_t FLUJO_ARRANQUE = 9ULL << 60;
+
+    // Movimientos aleatorios con los que se diversifican las copias de la mejor solucion previa
+    static const int MOVIMIENTOS_ARRANQUE = 3;
+
+    static uint64_t flujoSincrono(int iteracion, size_t indice) {
+        return (static_cast<uint64_t>(iteracion + 1) << 32) | static_cast<uint64_t>(indice);
+    }
 
-    Enjambre(int numLuciernagas, int dimension) : numLuciernagas(numLuciernagas) {
+    Enjambre(int numLuciernagas, int dimension, uint64_t semilla = 0)
+        : numLuciernagas(numLuciernagas), semilla(semilla), generador(semilla) {
         for (int i = 0; i < numLuciernagas; ++i) {
             luciernagas.emplace_back(dimension);
         }
         valoresObjetivo.resize(numLuciernagas, 0.0);
     }
 
-    double calcularAguaTotalRequerida(const Luciernaga& luciernaga, int numeroCultivos, int mes, double areaTotalDisponible,
-                                      const vector<double>& requerimientoAgua) const {
+    // Compila los datos de la Cultivacion que usan los operadores. Hay que volver a llamarlo si
+    // cambian los datos de la Cultivacion; las iteraciones lo hacen solas si cambia de instancia.
+    void compilarModelo(int numeroCultivos, int meses, const Cultivacion& cultivacion) {
+        modelo.compilar(numeroCultivos, meses, cultivacion);
+    }
+
+    void asegurarModelo(int numeroCultivos, int meses, const Cultivacion& cultivacion) {
+        if (!modelo.corresponde(cultivacion, numeroCultivos, meses)) compilarModelo(numeroCultivos, meses, cultivacion);
+    }
+
+    // Modelo compilado para esta Cultivacion; si no es el del enjambre, se compila en 'local'
+    const ModeloProblema& modeloPara(int numeroCultivos, int meses, const Cultivacion& cultivacion, ModeloProblema& local) const {
+        if (modelo.corresponde(cultivacion, numeroCultivos, meses)) return modelo;
+        local.compilar(numeroCultivos, meses, cultivacion);
+        return local;
+    }
+
+    template <class L>
+    double calcularAguaTotalRequerida(const L& luciernaga, int mes, const ModeloProblema& modelo) const {
         double aguaTotalRequerida = 0.0;
-        for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
-            int indice = cultivo + numeroCultivos * mes;
+        for (int cultivo = 0; cultivo < modelo.numeroCultivos; ++cultivo) {
+            int indice = cultivo + modelo.numeroCultivos * mes;
             double areaAsignada = luciernaga.valores[indice];
             if (areaAsignada > 0) {
-                aguaTotalRequerida += requerimientoAgua[cultivo] * areaAsignada * areaTotalDisponible;
+                aguaTotalRequerida += modelo.aguaPorArea[cultivo] * areaAsignada;
             }
         }
         return aguaTotalRequerida;
@@ -47,36 +142,34 @@ class Enjambre {
         return aguaTotalRequerida > 0 ? min(1.0, max(0.0, aguaTotalDisponible / aguaTotalRequerida)) : 1.0;
     }
 
-    double calcularCosechaCultivo(const Luciernaga& luciernaga, int numeroCultivos, int mes, double areaTotalDisponible,
-                                  double coeficienteAgua, double conductividadElectrica,
-                                  const vector<int>& mesesCultivo, const vector<double>& maxCosechaPorArea,
-                                  const vector<double>& susceptibilidadAgua, const vector<double>& reduccionRendimiento,
-                                  const vector<double>& salinidadCritica) const {
+    template <class L>
+    double calcularCosechaCultivo(const L& luciernaga, int mes, double coeficienteAgua, double conductividadElectrica,
+                                  const ModeloProblema& modelo) const {
         double cosechaMensual = 0.0;
-        for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
-            int indice = cultivo + numeroCultivos * mes;
+        for (int cultivo = 0; cultivo < modelo.numeroCultivos; ++cultivo) {
+            int indice = cultivo + modelo.numeroCultivos * mes;
             double areaAsignada = luciernaga.valores[indice];
 
             if (areaAsignada <= 0) continue;
 
-            double cosechaEsperada = (maxCosechaPorArea[cultivo] * areaAsignada) / mesesCultivo[cultivo];
-            double factorExponente = (coeficienteAgua * susceptibilidadAgua[cultivo]) / areaAsignada;
+            double cosechaEsperada = modelo.cosechaMensualPorArea[cultivo] * areaAsignada;
+            double factorExponente = (coeficienteAgua * modelo.susceptibilidadAgua[cultivo]) / areaAsignada;
             double efectoAgua = 1 - exp(-factorExponente);
-            double impactoSalinidad = reduccionRendimiento[cultivo] * (conductividadElectrica - salinidadCritica[cultivo]);
-            double efectoSalinidad = min(1.0, max(0.0, 1.0 - impactoSalinidad / 100.0));
+            double impactoSalinidad = modelo.reduccionPorUnidad[cultivo] * (conductividadElectrica - modelo.salinidadCritica[cultivo]);
+            double efectoSalinidad = min(1.0, max(0.0, 1.0 - impactoSalinidad));
             double cosechaReal = cosechaEsperada * efectoAgua * efectoSalinidad;
             cosechaMensual += cosechaReal;
         }
         return cosechaMensual;
     }
 
-    double actualizarSalinidad(const Luciernaga& luciernaga, int numeroCultivos, int mes, double areaTotalDisponible,
-                               const vector<double>& cambioSalinidadPorArea) const {
+    template <class L>
+    double actualizarSalinidad(const L& luciernaga, int mes, const ModeloProblema& modelo) const {
         double cambioTotalSalinidad = 0.0;
-        for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
-            int indice = cultivo + numeroCultivos * mes;
+        for (int cultivo = 0; cultivo < modelo.numeroCultivos; ++cultivo) {
+            int indice = cultivo + modelo.numeroCultivos * mes;
             double areaAsignada = luciernaga.valores[indice];
-            cambioTotalSalinidad += cambioSalinidadPorArea[cultivo] * (areaAsignada * areaTotalDisponible);
+            cambioTotalSalinidad += modelo.salinidadPorArea[cultivo] * areaAsignada;
         }
         return cambioTotalSalinidad;
     }
@@ -87,56 +180,359 @@ class Enjambre {
         }
     }
 
-    double funcionObjetivo(const Luciernaga& luciernaga, int numeroCultivos, int meses,
+    template <class L>
+    double funcionObjetivo(const L& luciernaga, int numeroCultivos, int meses,
                            Cultivacion& cultivacion) const {
+        ModeloProblema local;
+        return funcionObjetivo(luciernaga, modeloPara(numeroCultivos, meses, cultivacion, local));
+    }
+
+    template <class L>
+    double funcionObjetivo(const L& luciernaga, const ModeloProblema& modelo) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_FUNCION_OBJETIVO);
         double cosechaTotal = 0.0;
-        double conductividadElectrica = cultivacion.conductividadElectrica;
-        vector<double> aguaDisponible = cultivacion.aguaInicialDisponible;
+        double conductividadElectrica = modelo.conductividadElectrica;
+        double aguaMes = modelo.aguaInicialDisponible[0];
 
-        for (int mes = 0; mes < meses; ++mes) {
-            double aguaTotalRequerida = calcularAguaTotalRequerida(luciernaga, numeroCultivos, mes, cultivacion.areaTotalDisponible, cultivacion.requerimientoAgua);
-            double coeficienteAgua = calcularCoeficienteAgua(aguaTotalRequerida, aguaDisponible[mes]);
-            double cosechaMensual = calcularCosechaCultivo(luciernaga, numeroCultivos, mes, cultivacion.areaTotalDisponible,
-                                                           coeficienteAgua, conductividadElectrica, cultivacion.mesesCultivo,
-                                                           cultivacion.maxCosechaPorArea, cultivacion.susceptibilidadAgua, cultivacion.reduccionRendimiento, cultivacion.salinidadCritica);
+        for (int mes = 0; mes < modelo.meses; ++mes) {
+            double aguaTotalRequerida = calcularAguaTotalRequerida(luciernaga, mes, modelo);
+            double coeficienteAgua = calcularCoeficienteAgua(aguaTotalRequerida, aguaMes);
+            double cosechaMensual = calcularCosechaCultivo(luciernaga, mes, coeficienteAgua, conductividadElectrica, modelo);
+
+            if (mes < modelo.meses - 1) {
+                double cambioSalinidad = actualizarSalinidad(luciernaga, mes, modelo);
+                conductividadElectrica += cambioSalinidad;
+                // Pasar el agua restante de un mes al mes siguiente (como trasladarAgua, sin copiar el vector)
+                aguaMes = modelo.aguaInicialDisponible[mes + 1] + max(0.0, aguaMes - aguaTotalRequerida);
+            }
+            cosechaTotal += cosechaMensual;
+        }
+
+        return cosechaTotal;
+    }
+
+    // Cosecha, agua requerida y salinidad final en una sola pasada. La cosecha es exactamente la de
+    // funcionObjetivo; la salinidad incluye tambien el cambio del ultimo mes.
+    template <class L>
+    Objetivos funcionObjetivos(const L& luciernaga, const ModeloProblema& modelo) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_FUNCION_OBJETIVO);
+        Objetivos objetivos;
+        double conductividadElectrica = modelo.conductividadElectrica;
+        double aguaMes = modelo.aguaInicialDisponible[0];
+
+        for (int mes = 0; mes < modelo.meses; ++mes) {
+            double aguaTotalRequerida = calcularAguaTotalRequerida(luciernaga, mes, modelo);
+            double coeficienteAgua = calcularCoeficienteAgua(aguaTotalRequerida, aguaMes);
+            double cosechaMensual = calcularCosechaCultivo(luciernaga, mes, coeficienteAgua, conductividadElectrica, modelo);
+
+            conductividadElectrica += actualizarSalinidad(luciernaga, mes, modelo);
+            if (mes < modelo.meses - 1) {
+                aguaMes = modelo.aguaInicialDisponible[mes + 1] + max(0.0, aguaMes - aguaTotalRequerida);
+            }
+            objetivos.cosecha += cosechaMensual;
+            objetivos.agua += aguaTotalRequerida;
+        }
+        objetivos.salinidad = conductividadElectrica;
+        return objetivos;
+    }
+
+    // Igual que funcionObjetivo, pero parte del estado guardado en 'base' al comienzo de mesInicio
+    // y escribe en 'destino' los meses recalculados. Con mesInicio = 0 es una evaluacion completa.
+    template <class L>
+    double evaluarDesde(const L& luciernaga, int mesInicio, const TrayectoriaEvaluacion& base,
+                        TrayectoriaEvaluacion& destino, const ModeloProblema& modelo) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_EVALUAR_DESDE);
+        int meses = modelo.meses;
+        double cosechaTotal = 0.0;
+        double conductividadElectrica = modelo.conductividadElectrica;
+        double aguaMes = modelo.aguaInicialDisponible[0];
+        if (mesInicio > 0) {
+            cosechaTotal = base.cosechaAntesMes[mesInicio];
+            conductividadElectrica = base.conductividadInicioMes[mesInicio];
+            aguaMes = base.aguaInicioMes[mesInicio];
+        }
+
+        for (int mes = mesInicio; mes < meses; ++mes) {
+            destino.aguaInicioMes[mes] = aguaMes;
+            destino.conductividadInicioMes[mes] = conductividadElectrica;
+            destino.cosechaAntesMes[mes] = cosechaTotal;
+
+            double aguaTotalRequerida = calcularAguaTotalRequerida(luciernaga, mes, modelo);
+            double coeficienteAgua = calcularCoeficienteAgua(aguaTotalRequerida, aguaMes);
+            double cosechaMensual = calcularCosechaCultivo(luciernaga, mes, coeficienteAgua, conductividadElectrica, modelo);
 
             if (mes < meses - 1) {
-                double cambioSalinidad = actualizarSalinidad(luciernaga, numeroCultivos, mes, cultivacion.areaTotalDisponible, cultivacion.cambioSalinidadPorArea);
+                double cambioSalinidad = actualizarSalinidad(luciernaga, mes, modelo);
                 conductividadElectrica += cambioSalinidad;
+                // Pasar el agua restante de un mes al mes siguiente
+                aguaMes = modelo.aguaInicialDisponible[mes + 1] + max(0.0, aguaMes - aguaTotalRequerida);
             }
-            // Pasar el agua restante de un mes al mes siguiente
-            trasladarAgua(aguaDisponible, mes, aguaTotalRequerida);
             cosechaTotal += cosechaMensual;
         }
+        destino.aguaInicioMes[meses] = aguaMes;
+        destino.conductividadInicioMes[meses] = conductividadElectrica;
+        destino.cosechaAntesMes[meses] = cosechaTotal;
 
         return cosechaTotal;
     }
 
     void actualizarValorObjetivo(size_t indice, int numeroCultivos, int meses, Cultivacion& cultivacion) {
-        double valor = funcionObjetivo(luciernagas[indice], numeroCultivos, meses, cultivacion);
-        luciernagas[indice].valorObjetivo = valor;
-        valoresObjetivo[indice] = valor;
+        actualizarValorObjetivoDesde(indice, 0, numeroCultivos, meses, cultivacion);
+    }
+
+    // Reevalua la luciernaga 'indice' sabiendo que solo cambiaron los meses desde mesInicio
+    void actualizarValorObjetivoDesde(size_t indice, int mesInicio, int numeroCultivos, int meses, Cultivacion& cultivacion) {
+        if (mesInicio >= meses) return;
+        VistaLuciernaga luciernaga = vista(indice);
+        luciernaga.valorObjetivo = evaluarDesde(luciernaga, mesInicio, trayectorias[indice], trayectorias[indice], modelo);
+        ++evaluacionesLuciernaga[indice];
+        anotarEnCache(indice);
+    }
+
+    // Guarda en cacheEvaluaciones, si la hay, el valor recien calculado de la luciernaga 'indice'
+    void anotarEnCache(size_t indice) {
+        if (!cacheEvaluaciones) return;
+        VistaLuciernaga luciernaga = vista(indice);
+        cacheEvaluaciones->guardar(cacheEvaluaciones->huella(luciernaga.valores.data(), luciernaga.valores.size()),
+                                   luciernaga.valorObjetivo);
     }
 
     void inicializarValoresObjetivo(int numeroCultivos, int meses, Cultivacion& cultivacion) {
+        asegurarModelo(numeroCultivos, meses, cultivacion);
         valoresObjetivo.resize(luciernagas.size());
+        trayectorias.resize(luciernagas.size());
+        prepararContadores(luciernagas.size());
         for (size_t i = 0; i < luciernagas.size(); ++i) {
+            trayectorias[i].redimensionar(meses);
             actualizarValorObjetivo(i, numeroCultivos, meses, cultivacion);
+            luciernagas[i].valorObjetivo = valoresObjetivo[i];
+        }
+    }
+
+    // Igual que inicializarValoresObjetivo, pero puntuando la generacion entera con evaluarGeneracion
+    void inicializarValoresObjetivo(int numeroCultivos, int meses, Cultivacion& cultivacion, PoolHilos& pool) {
+        valoresObjetivo.resize(luciernagas.size());
+        trayectorias.resize(luciernagas.size());
+        prepararContadores(luciernagas.size());
+        for (size_t i = 0; i < luciernagas.size(); ++i) {
+            trayectorias[i].redimensionar(meses);
+        }
+        evaluarGeneracion(numeroCultivos, meses, cultivacion, pool);
+        for (size_t i = 0; i < luciernagas.size(); ++i) {
+            luciernagas[i].valorObjetivo = valoresObjetivo[i];
+        }
+    }
+
+    // Evalua todas las luciernagas desde el primer mes, por bloques de EvaluadorLotes::anchoLote()
+    // luciernagas que se reparten entre los hilos, y rehace sus trayectorias
+    void evaluarGeneracion(int numeroCultivos, int meses, Cultivacion& cultivacion, PoolHilos& pool) {
+        asegurarModelo(numeroCultivos, meses, cultivacion);
+        size_t ancho = EvaluadorLotes::anchoLote(KernelsSimd::nivelActivo());
+        size_t bloques = (valoresObjetivo.size() + ancho - 1) / ancho;
+
+        pool.paraCada(bloques, [&](size_t inicio, size_t fin, int) {
+            const double* filas[8];
+            TrayectoriaEvaluacion* destinos[8];
+            for (size_t b = inicio; b < fin; ++b) {
+                size_t primero = b * ancho;
+                size_t cuenta = min(ancho, valoresObjetivo.size() - primero);
+                for (size_t l = 0; l < cuenta; ++l) ++evaluacionesLuciernaga[primero + l];
+                if (ancho == 1) {
+                    VistaLuciernaga luciernaga = vista(primero);
+                    luciernaga.valorObjetivo = evaluarDesde(luciernaga, 0, trayectorias[primero], trayectorias[primero], modelo);
+                    anotarEnCache(primero);
+                    continue;
+                }
+                for (size_t l = 0; l < cuenta; ++l) {
+                    filas[l] = vista(primero + l).valores.data();
+                    destinos[l] = &trayectorias[primero + l];
+                }
+                EvaluadorLotes::evaluar(filas, cuenta, &valoresObjetivo[primero], destinos, modelo);
+                for (size_t l = 0; l < cuenta; ++l) anotarEnCache(primero + l);
+            }
+        });
+    }
+
+    void prepararContadores(size_t n) {
+        evaluacionesLuciernaga.resize(n, 0);
+        movimientosAceptados.resize(n, 0);
+        movimientosRevertidos.resize(n, 0);
+    }
+
+    // Deja el enjambre listo para resolver otro problema con otra semilla, conservando la memoria
+    // ya reservada (espacios de trabajo, trayectorias, copias de la generacion anterior). Los
+    // contadores vuelven a cero y el modelo se marca como no compilado, porque la Cultivacion
+    // nueva podria ocupar la misma direccion que la anterior. Los modos y parametros no se tocan.
+    void reiniciar(uint64_t semilla) {
+        this->semilla = semilla;
+        generador = GeneradorAleatorio(semilla);
+        modelo.origen = nullptr;
+        almacenamientoContiguo = false;
+        evaluacionesLuciernaga.assign(evaluacionesLuciernaga.size(), 0);
+        movimientosAceptados.assign(movimientosAceptados.size(), 0);
+        movimientosRevertidos.assign(movimientosRevertidos.size(), 0);
+    }
+
+    unsigned long long evaluaciones() const {
+        unsigned long long total = 0;
+        for (size_t i = 0; i < evaluacionesLuciernaga.size(); ++i) total += evaluacionesLuciernaga[i];
+        return total;
+    }
+
+    // Totales de movimientos aleatorios mantenidos y revertidos desde el principio
+    void movimientosAleatorios(unsigned long long& aceptados, unsigned long long& revertidos) const {
+        aceptados = 0;
+        revertidos = 0;
+        for (size_t i = 0; i < movimientosAceptados.size(); ++i) {
+            aceptados += movimientosAceptados[i];
+            revertidos += movimientosRevertidos[i];
+        }
+    }
+
+    // Deja listo un espacio de trabajo por hilo. Solo pide memoria la primera vez.
+    void prepararEspacioHilos(int numHilos, int numeroCultivos, int meses) {
+        if (espaciosTrabajo.size() < static_cast<size_t>(numHilos)) {
+            espaciosTrabajo.resize(numHilos);
+        }
+        size_t maxCandidatos = modoAtraccion == ATRACCION_VECINOS ? indiceVecinos.maxCandidatos() : 0;
+        size_t maxCompaneras = modoActualizacion == ACTUALIZACION_COMBINADA ? luciernagas.size() : 0;
+        for (int h = 0; h < numHilos; ++h) {
+            espaciosTrabajo[h].preparar(meses, dimension(), maxCandidatos, maxCompaneras);
+        }
+    }
+
+    size_t dimension() const {
+        if (almacenamientoContiguo) return posiciones.dimension();
+        return luciernagas.empty() ? 0 : luciernagas[0].valores.size();
+    }
+
+    // Vista sobre la posicion vigente de la luciernaga 'i', en cualquiera de los dos almacenamientos
+    VistaLuciernaga vista(size_t i) {
+        if (almacenamientoContiguo) return VistaLuciernaga(posiciones.fila(i), posiciones.dimension(), valoresObjetivo[i]);
+        return VistaLuciernaga(luciernagas[i].valores.data(), luciernagas[i].valores.size(), valoresObjetivo[i]);
+    }
+
+    // Vista sobre la copia de la generacion anterior que usa la actualizacion sincrona
+    VistaLuciernaga vistaAnterior(size_t j) {
+        if (almacenamientoContiguo) return VistaLuciernaga(posicionesAnteriores.fila(j), posicionesAnteriores.dimension(), objetivosAnteriores[j]);
+        return VistaLuciernaga(generacionAnterior[j].valores.data(), generacionAnterior[j].valores.size(), objetivosAnteriores[j]);
+    }
+
+    // Pasa las posiciones de 'luciernagas' a una unica matriz contigua y alineada.
+    // Desde ese momento los operadores trabajan sobre la matriz.
+    void activarAlmacenamientoContiguo() {
+        if (almacenamientoContiguo) return;
+        size_t dim = dimension();
+        posiciones.redimensionar(luciernagas.size(), dim);
+        for (size_t i = 0; i < luciernagas.size(); ++i) {
+            copy(luciernagas[i].valores.begin(), luciernagas[i].valores.end(), posiciones.fila(i));
         }
+        almacenamientoContiguo = true;
+    }
+
+    // Copia la matriz contigua de vuelta a 'luciernagas' (por ejemplo antes de imprimirlas)
+    void volcarPosiciones() {
+        for (size_t i = 0; i < luciernagas.size(); ++i) {
+            if (almacenamientoContiguo) {
+                const double* fila = posiciones.fila(i);
+                copy(fila, fila + posiciones.dimension(), luciernagas[i].valores.begin());
+            }
+            luciernagas[i].valorObjetivo = valoresObjetivo[i];
+        }
+    }
+
+    // Movimiento aleatorio de la luciernaga 'indice' que se revierte si empeora el valor objetivo.
+    // Se evalua en el sitio: las celdas cambiadas quedan en el registro del espacio de trabajo y
+    // solo se reevaluan los meses a partir del primero que cambio.
+    void movimientoAleatorioConReversion(size_t indice, int numeroCultivos, int meses, Cultivacion& cultivacion,
+                                         GeneradorAleatorio& generador, EspacioTrabajo& espacio) {
+        VistaLuciernaga luciernaga = vista(indice);
+        TrayectoriaEvaluacion& tentativa = espacio.trayectoriaTentativa;
+        RegistroDeshacer& registro = espacio.registro;
+        registro.limpiar();
+
+        int mesCambio = movimientoAleatorio(luciernaga, modelo, generador, &registro);
+        mesCambio = min(mesCambio, repararSiActivo(luciernaga, espacio, &registro));
+        if (mesCambio >= meses) return;
+
+        uint64_t huella = 0;
+        if (cacheEvaluaciones) {
+            huella = cacheEvaluaciones->huella(luciernaga.valores.data(), luciernaga.valores.size());
+            double valorConocido;
+            if (cacheEvaluaciones->buscar(huella, valorConocido) && valorConocido < luciernaga.valorObjetivo) {
+                registro.deshacer(luciernaga.valores.data());
+                ++movimientosRevertidos[indice];
+                return;
+            }
+        }
+
+        double nuevoValor = evaluarDesde(luciernaga, mesCambio, trayectorias[indice], tentativa, modelo);
+        ++evaluacionesLuciernaga[indice];
+        if (cacheEvaluaciones) cacheEvaluaciones->guardar(huella, nuevoValor);
+        // Revertir si la nueva posicion es peor
+        if (nuevoValor < luciernaga.valorObjetivo) {
+            registro.deshacer(luciernaga.valores.data());
+            ++movimientosRevertidos[indice];
+        } else {  // Actualizar el valor objetivo de lo contrario
+            trayectorias[indice].copiarDesde(tentativa, mesCambio);
+            luciernaga.valorObjetivo = nuevoValor;
+            ++movimientosAceptados[indice];
+        }
+    }
+
+    // Repara la luciernaga si repararFactibilidad; devuelve el primer mes cambiado, o meses
+    template <class L>
+    int repararSiActivo(L& luciernaga, EspacioTrabajo& espacio, RegistroDeshacer* registro = nullptr) const {
+        if (!repararFactibilidad) return modelo.meses;
+        return espacio.reparacion.reparar(luciernaga.valores.data(), modelo, registro);
     }
 
     double calcularAtractivo(double distancia) const {
         return beta0 * exp(-gamma * pow(distancia, 2));
     }
 
-    double calcularDistancia(const Luciernaga& luciernaga1, const Luciernaga& luciernaga2) const {
-        double suma = 0.0;
-        for (size_t i = 0; i < luciernaga1.valores.size(); ++i) {
-            suma += pow(luciernaga2.valores[i] - luciernaga1.valores[i], 2);
+    template <class L, class M>
+    double calcularDistancia(const L& luciernaga1, const M& luciernaga2) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_CALCULAR_DISTANCIA);
+        return sqrt(KernelsSimd::distanciaCuadrada(luciernaga1.valores.data(), luciernaga2.valores.data(),
+                                                   luciernaga1.valores.size()));
+    }
+
+    // Distancia media de las luciernagas a su centroide, que queda en 'centroide' (memoria del
+    // llamador, reutilizada). Mide cuanto se ha concentrado el enjambre.
+    double calcularDiversidad(Luciernaga& centroide) {
+        size_t n = valoresObjetivo.size();
+        size_t dim = dimension();
+        centroide.valores.assign(dim, 0.0);
+        if (n == 0) return 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            VistaLuciernaga luciernaga = vista(i);
+            for (size_t d = 0; d < dim; ++d) centroide.valores[d] += luciernaga.valores[d];
         }
-        return sqrt(suma);
+        for (size_t d = 0; d < dim; ++d) centroide.valores[d] /= n;
+        double distancias = 0.0;
+        for (size_t i = 0; i < n; ++i) distancias += calcularDistancia(vista(i), centroide);
+        return distancias / n;
+    }
+
+    // Numero de companeras que recorre la luciernaga i: todas, o sus vecinas en indiceVecinos
+    // (que quedan en espacio.vecinos). La c-esima se obtiene con companera(c, espacio).
+    size_t prepararCompaneras(size_t i, EspacioTrabajo& espacio) const {
+        if (modoAtraccion != ATRACCION_VECINOS) return luciernagas.size();
+        indiceVecinos.buscar(i, vecinosAtraccion, espacio.candidatosVecinos, espacio.vecinos);
+        return espacio.vecinos.size();
     }
 
+    size_t companera(size_t c, const EspacioTrabajo& espacio) const {
+        return modoAtraccion == ATRACCION_VECINOS ? espacio.vecinos[c] : c;
+    }
+
+    // Atractivo hacia una fila entera de companeras a partir de sus distancias al cuadrado
+    void calcularAtractivos(const double* distanciasCuadradas, double* betas, size_t cuenta) const {
+        KernelsSimd::atractivos(distanciasCuadradas, betas, cuenta, beta0, gamma);
+    }
+
+    // Los operadores usan las listas ya calculadas de ModeloProblema (validosMes / numValidosMes)
     vector<int> identificarCultivosValidos(int mes, int numeroCultivos, const vector<int>& mesesCultivo, const vector<int>& cultivable) const {
         vector<int> cultivosValidos;
         for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
@@ -147,7 +543,8 @@ class Enjambre {
         return cultivosValidos;
     }
 
-    double calcularAreaMesActual(const Luciernaga& luciernaga, int numeroCultivos, int mes) const {
+    template <class L>
+    double calcularAreaMesActual(const L& luciernaga, int numeroCultivos, int mes) const {
         double areaMesActual = 0.0;
         for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
             areaMesActual += luciernaga.valores[cultivo + numeroCultivos * mes];
@@ -159,8 +556,10 @@ class Enjambre {
         return max(0.0, min(1.0, valorActual + incremento));
     }
 
-    bool verificarDisponibilidadAreaMesesSiguientes(const Luciernaga& luciernaga, int cultivoSeleccionado, int numeroCultivos,
+    template <class L>
+    bool verificarDisponibilidadAreaMesesSiguientes(const L& luciernaga, int cultivoSeleccionado, int numeroCultivos,
                                                     int mes, int meses, int periodoCrecimiento, double incremento) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_VERIFICAR_DISPONIBILIDAD);
         for (int m = 1; m < periodoCrecimiento && (mes + m) < meses; ++m) {
             double areaTotalMes = 0.0;
             for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
@@ -178,59 +577,162 @@ class Enjambre {
         return true;
     }
 
-    void actualizarAreasMesesSiguientes(Luciernaga& luciernaga, int cultivoSeleccionado, int numeroCultivos,
-                                        int mes, int meses, int periodoCrecimiento, double incremento) const {
+    template <class L>
+    void actualizarAreasMesesSiguientes(L& luciernaga, int cultivoSeleccionado, int numeroCultivos, int mes, int meses,
+                                        int periodoCrecimiento, double incremento, RegistroDeshacer* registro) const {
         for (int m = 0; m < periodoCrecimiento && (mes + m) < meses; ++m) {
             int indice = cultivoSeleccionado + numeroCultivos * (mes + m);
+            if (registro) registro->anotar(indice, luciernaga.valores[indice]);
             luciernaga.valores[indice] = aplicarIncremento(luciernaga.valores[indice], incremento);
         }
     }
 
-    void movimientoAleatorio(Luciernaga& luciernaga, int numeroCultivos, int meses, Cultivacion& cultivacion) const {
+    // Devuelve el primer mes modificado, o 'meses' si no se modifico ninguno
+    template <class L>
+    int movimientoAleatorio(L& luciernaga, int numeroCultivos, int meses, Cultivacion& cultivacion,
+                            GeneradorAleatorio& generador) const {
+        ModeloProblema local;
+        return movimientoAleatorio(luciernaga, modeloPara(numeroCultivos, meses, cultivacion, local), generador);
+    }
+
+    // Si se da 'registro', anota en el las celdas que cambia
+    template <class L>
+    int movimientoAleatorio(L& luciernaga, const ModeloProblema& modelo, GeneradorAleatorio& generador,
+                            RegistroDeshacer* registro = nullptr) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_MOVIMIENTO_ALEATORIO);
+        int numeroCultivos = modelo.numeroCultivos;
+        int meses = modelo.meses;
+        int primerMesCambiado = meses;
         for (int mes = 0; mes < meses; ++mes) {
-            vector<int> cultivosValidos = identificarCultivosValidos(mes, numeroCultivos,
-                                                                     cultivacion.mesesCultivo,
-                                                                     cultivacion.cultivable);
-            if (cultivosValidos.empty()) continue;
+            int numValidos = modelo.numValidosMes(mes);
+            if (numValidos == 0) continue;
 
-            int cultivoSeleccionado = cultivosValidos[rand() % cultivosValidos.size()];
+            int cultivoSeleccionado = modelo.validosMes(mes)[generador.entero(numValidos)];
             int indice = cultivoSeleccionado + numeroCultivos * mes;
 
             double areaMesActual = calcularAreaMesActual(luciernaga, numeroCultivos, mes);
 
-            double incremento = alfa * (static_cast<double>(rand()) / RAND_MAX - 0.5);
+            double incremento = alfa * (generador.uniforme() - 0.5);
             double nuevoValor = aplicarIncremento(luciernaga.valores[indice], incremento);
 
             if (areaMesActual - luciernaga.valores[indice] + nuevoValor > 1.0) continue;
 
             if (verificarDisponibilidadAreaMesesSiguientes(luciernaga, cultivoSeleccionado, numeroCultivos, mes, meses,
-                                                           cultivacion.mesesCultivo[cultivoSeleccionado], incremento))
+                                                           modelo.mesesCultivo[cultivoSeleccionado], incremento)) {
                 actualizarAreasMesesSiguientes(luciernaga, cultivoSeleccionado, numeroCultivos, mes, meses,
-                                               cultivacion.mesesCultivo[cultivoSeleccionado], incremento);
+                                               modelo.mesesCultivo[cultivoSeleccionado], incremento, registro);
+                primerMesCambiado = min(primerMesCambiado, mes);
+            }
         }
+        return primerMesCambiado;
     }
 
-    void moverLuciernaga(Luciernaga& luciernaga, const Luciernaga& mejorLuciernaga, double beta, int numeroCultivos, int meses,
-                         Cultivacion& cultivacion) {
-        for (size_t i = 0; i < luciernaga.valores.size(); ++i) {
-            luciernaga.valores[i] += beta * (mejorLuciernaga.valores[i] - luciernaga.valores[i]);
-            luciernaga.valores[i] = max(0.0, min(1.0, luciernaga.valores[i]));
-        }
-        movimientoAleatorio(luciernaga, numeroCultivos, meses, cultivacion);
+    // Devuelve el primer mes modificado, o 'meses' si no se modifico ninguno
+    template <class L, class M>
+    int moverLuciernaga(L& luciernaga, const M& mejorLuciernaga, double beta, int numeroCultivos, int meses,
+                        Cultivacion& cultivacion, GeneradorAleatorio& generador) const {
+        ModeloProblema local;
+        return moverLuciernaga(luciernaga, mejorLuciernaga, beta, modeloPara(numeroCultivos, meses, cultivacion, local), generador);
+    }
+
+    template <class L, class M>
+    int moverLuciernaga(L& luciernaga, const M& mejorLuciernaga, double beta, const ModeloProblema& modelo,
+                        GeneradorAleatorio& generador) const {
+        size_t primerIndiceCambiado = KernelsSimd::moverYAcotar(luciernaga.valores.data(), mejorLuciernaga.valores.data(),
+                                                                beta, luciernaga.valores.size());
+        int primerMesCambiado = static_cast<int>(primerIndiceCambiado / modelo.numeroCultivos);
+        return min(primerMesCambiado, movimientoAleatorio(luciernaga, modelo, generador));
     }
 
+    // Genera las numLuciernagas posiciones iniciales (sustituye a las que hubiera). Cada luciernaga
+    // usa su propio flujo, asi que el resultado es el mismo en serie o repartido entre hilos.
     void inicializarLuciernagas(int numeroCultivos, int meses, Cultivacion& cultivacion) {
-        int dimension = numeroCultivos * meses;
+        prepararInicializacion(numeroCultivos, meses, cultivacion);
+        for (size_t k = 0; k < luciernagas.size(); ++k) {
+            inicializarLuciernaga(k);
+        }
+        terminarInicializacion();
+    }
+
+    void inicializarLuciernagas(int numeroCultivos, int meses, Cultivacion& cultivacion, PoolHilos& pool) {
+        prepararInicializacion(numeroCultivos, meses, cultivacion);
+        pool.paraCada(luciernagas.size(), [this](size_t inicio, size_t fin, int) {
+            for (size_t k = inicio; k < fin; ++k) {
+                inicializarLuciernaga(k);
+            }
+        });
+        terminarInicializacion();
+    }
 
-        for (int k = 0; k < numLuciernagas; ++k) {
-            Luciernaga nuevaLuciernaga = Luciernaga::inicializar(dimension, numeroCultivos, meses,
-                                                                 cultivacion.mesesCultivo,
-                                                                 cultivacion.requerimientoAgua,
-                                                                 cultivacion.cultivable,
-                                                                 cultivacion.aguaInicialDisponible,
-                                                                 cultivacion.areaTotalDisponible,
-                                                                 alfa);
-            luciernagas.push_back(nuevaLuciernaga);
+    void prepararInicializacion(int numeroCultivos, int meses, Cultivacion& cultivacion) {
+        asegurarModelo(numeroCultivos, meses, cultivacion);
+        luciernagas.assign(numLuciernagas, Luciernaga(0));
+        valoresObjetivo.assign(numLuciernagas, 0.0);
+    }
+
+    void inicializarLuciernaga(size_t k) {
+        GeneradorAleatorio generadorLuciernaga(semilla, FLUJO_INICIALIZACION + k);
+        if (estrategiaInicializacion == INICIALIZACION_FACTIBLE)
+            luciernagas[k] = Luciernaga::inicializarFactible(modelo, generadorLuciernaga);
+        else
+            luciernagas[k] = Luciernaga::inicializar(modelo, alfa, generadorLuciernaga);
+        if (repararFactibilidad) ReparacionFactibilidad().reparar(luciernagas[k].valores.data(), modelo);
+    }
+
+    // Arranque en caliente: sustituye las 'cuantas' primeras luciernagas por soluciones de una
+    // ejecucion anterior ('previas', la mejor primero), adaptadas a la Cultivacion actual. Si hay
+    // menos previas que huecos, el resto son la mejor con unos movimientos aleatorios, cada una con
+    // su propio flujo. Va entre inicializarLuciernagas e inicializarValoresObjetivo.
+    void sembrarLuciernagas(const vector<Luciernaga>& previas, size_t cuantas, int numeroCultivos, int meses,
+                            const Cultivacion& cultivacion) {
+        asegurarModelo(numeroCultivos, meses, cultivacion);
+        cuantas = min(cuantas, luciernagas.size());
+        if (previas.empty()) return;
+        for (size_t k = 0; k < cuantas; ++k) {
+            VistaLuciernaga luciernaga = vista(k);
+            const vector<double>& origen = previas[min(k, previas.size() - 1)].valores;
+            if (origen.size() != luciernaga.valores.size()) continue;
+            copy(origen.begin(), origen.end(), luciernaga.valores.begin());
+            adaptarLuciernaga(luciernaga, cultivacion);
+            if (k < previas.size()) continue;
+            GeneradorAleatorio generadorLuciernaga(semilla, FLUJO_ARRANQUE + k);
+            for (int movimiento = 0; movimiento < MOVIMIENTOS_ARRANQUE; ++movimiento) {
+                movimientoAleatorio(luciernaga, modelo, generadorLuciernaga);
+            }
+        }
+        if (repararFactibilidad) {
+            ReparacionFactibilidad reparacion;
+            for (size_t k = 0; k < cuantas; ++k) reparacion.reparar(vista(k).valores.data(), modelo);
+        }
+    }
+
+    // Ajusta una posicion de otra instancia de la misma forma a las restricciones de esta: areas
+    // en [0, 1], cero donde el cultivo ya no es cultivable y, si un mes suma mas de 1, todas sus
+    // areas escaladas en proporcion. El agua no se toca: la escasez ya la penaliza el objetivo.
+    template <class L>
+    void adaptarLuciernaga(L& luciernaga, const Cultivacion& cultivacion) const {
+        int numeroCultivos = modelo.numeroCultivos;
+        for (int mes = 0; mes < modelo.meses; ++mes) {
+            double areaMes = 0.0;
+            for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+                size_t indice = cultivo + static_cast<size_t>(numeroCultivos) * mes;
+                double area = max(0.0, min(1.0, luciernaga.valores[indice]));
+                if (indice < cultivacion.cultivable.size() && cultivacion.cultivable[indice] == 0) area = 0.0;
+                luciernaga.valores[indice] = area;
+                areaMes += area;
+            }
+            if (areaMes <= 1.0) continue;
+            for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+                luciernaga.valores[cultivo + static_cast<size_t>(numeroCultivos) * mes] /= areaMes;
+            }
+        }
+    }
+
+    // Si ya se usaba la matriz contigua, se vuelve a llenar con las posiciones nuevas
+    void terminarInicializacion() {
+        if (almacenamientoContiguo) {
+            almacenamientoContiguo = false;
+            activarAlmacenamientoContiguo();
         }
     }
 
@@ -241,18 +743,186 @@ class Enjambre {
         }
     }
 
-    Luciernaga encontrarMejorLuciernaga() const {
-        Luciernaga mejorLuciernaga = luciernagas[0];
-        double mejorValor = valoresObjetivo[0];
+    size_t indiceMejorLuciernaga() const {
+        size_t mejor = 0;
+        for (size_t i = 1; i < valoresObjetivo.size(); ++i) {
+            if (valoresObjetivo[i] > valoresObjetivo[mejor]) {
+                mejor = i;
+            }
+        }
+        return mejor;
+    }
+
+    Luciernaga encontrarMejorLuciernaga() {
+        return vista(indiceMejorLuciernaga()).copiar();
+    }
+
+    // Copia la luciernaga 'i' en 'destino' reutilizando su memoria
+    void copiarLuciernaga(size_t i, Luciernaga& destino) {
+        VistaLuciernaga origen = vista(i);
+        destino.valores.assign(origen.valores.begin(), origen.valores.end());
+        destino.valorObjetivo = origen.valorObjetivo;
+    }
+
+    // Sustituye la posicion de la luciernaga 'i' por la de 'nueva' y la vuelve a evaluar
+    void reemplazarLuciernaga(size_t i, const Luciernaga& nueva, int numeroCultivos, int meses, Cultivacion& cultivacion) {
+        assert(nueva.valores.size() == dimension());
+        VistaLuciernaga destino = vista(i);
+        copy(nueva.valores.begin(), nueva.valores.end(), destino.valores.begin());
+        actualizarValorObjetivo(i, numeroCultivos, meses, cultivacion);
+        luciernagas[i].valorObjetivo = valoresObjetivo[i];
+    }
 
-        for (size_t i = 1; i < luciernagas.size(); ++i) {
-            if (valoresObjetivo[i] > mejorValor) {
-                mejorLuciernaga = luciernagas[i];
-                mejorValor = valoresObjetivo[i];
+    // Una iteracion del algoritmo original: cada luciernaga se mueve hacia las mas brillantes
+    // viendo ya las posiciones actualizadas de las anteriores (actualizacion Gauss-Seidel)
+    void iterarSecuencial(int numeroCultivos, int meses, Cultivacion& cultivacion) {
+        asegurarModelo(numeroCultivos, meses, cultivacion);
+        if (modoAtraccion == ATRACCION_VECINOS) {
+            // Las vecinas se buscan sobre las posiciones al empezar la iteracion
+            filasIndice.resize(luciernagas.size());
+            for (size_t i = 0; i < luciernagas.size(); ++i) filasIndice[i] = vista(i).valores.data();
+            indiceVecinos.construir(filasIndice, dimension(), vecinosAtraccion, semilla);
+        }
+        prepararEspacioHilos(1, numeroCultivos, meses);
+        EspacioTrabajo& espacio = espaciosTrabajo[0];
+        for (size_t i = 0; i < luciernagas.size(); ++i) {
+            VistaLuciernaga luciernaga = vista(i);
+            size_t numCompaneras = prepararCompaneras(i, espacio);
+            for (size_t c = 0; c < numCompaneras; ++c) {
+                size_t j = companera(c, espacio);
+                if (i == j) {
+                    movimientoAleatorioConReversion(i, numeroCultivos, meses, cultivacion, generador, espacio);
+                } else {
+                    if (valoresObjetivo[j] > valoresObjetivo[i]) {
+                        VistaLuciernaga otra = vista(j);
+                        double distancia = calcularDistancia(luciernaga, otra);
+                        double beta = calcularAtractivo(distancia);
+                        if (beta < umbralAtractivo) continue;
+
+                        int mesCambio = moverLuciernaga(luciernaga, otra, beta, modelo, generador);
+                        mesCambio = min(mesCambio, repararSiActivo(luciernaga, espacio));
+                        actualizarValorObjetivoDesde(i, mesCambio, numeroCultivos, meses, cultivacion);
+                    }
+                }
             }
         }
+    }
 
-        return mejorLuciernaga;
+    // Una iteracion sincrona (Jacobi): todas las luciernagas se mueven hacia una copia de la
+    // generacion anterior, de modo que cada una se puede actualizar en un hilo distinto.
+    // Cada luciernaga usa su propio flujo derivado de (semilla, iteracion, indice), por lo
+    // que el resultado no depende del reparto entre hilos.
+    void iterarSincrono(int numeroCultivos, int meses, Cultivacion& cultivacion, PoolHilos& pool, int iteracion) {
+        if (almacenamientoContiguo)
+            posicionesAnteriores = posiciones;
+        else
+            generacionAnterior = luciernagas;
+        objetivosAnteriores = valoresObjetivo;
+        asegurarModelo(numeroCultivos, meses, cultivacion);
+        if (modoAtraccion == ATRACCION_VECINOS) {
+            filasIndice.resize(luciernagas.size());
+            for (size_t j = 0; j < luciernagas.size(); ++j) filasIndice[j] = vistaAnterior(j).valores.data();
+            indiceVecinos.construir(filasIndice, dimension(), vecinosAtraccion, semilla, pool);
+        }
+        prepararEspacioHilos(pool.numHilos(), numeroCultivos, meses);
+
+        pool.paraCada(luciernagas.size(), [&](size_t inicio, size_t fin, int hilo) {
+            for (size_t i = inicio; i < fin; ++i) {
+                GeneradorAleatorio generadorLuciernaga(semilla, flujoSincrono(iteracion, i));
+                actualizarSincrono(i, numeroCultivos, meses, cultivacion, generadorLuciernaga, espaciosTrabajo[hilo]);
+            }
+        });
+    }
+
+    void actualizarSincrono(size_t i, int numeroCultivos, int meses, Cultivacion& cultivacion, GeneradorAleatorio& generador,
+                            EspacioTrabajo& espacio) {
+        VistaLuciernaga luciernaga = vista(i);
+        size_t numCompaneras = prepararCompaneras(i, espacio);
+        for (size_t c = 0; c < numCompaneras; ++c) {
+            size_t j = companera(c, espacio);
+            if (i == j) {
+                movimientoAleatorioConReversion(i, numeroCultivos, meses, cultivacion, generador, espacio);
+            } else if (objetivosAnteriores[j] > valoresObjetivo[i]) {
+                VistaLuciernaga otra = vistaAnterior(j);
+                double distancia = calcularDistancia(luciernaga, otra);
+                double beta = calcularAtractivo(distancia);
+                if (beta < umbralAtractivo) continue;
+
+                int mesCambio = moverLuciernaga(luciernaga, otra, beta, modelo, generador);
+                mesCambio = min(mesCambio, repararSiActivo(luciernaga, espacio));
+                actualizarValorObjetivoDesde(i, mesCambio, numeroCultivos, meses, cultivacion);
+            }
+        }
+    }
+
+    // Una iteracion con ACTUALIZACION_COMBINADA. Cada luciernaga suma la atraccion de todas sus
+    // companeras mas brillantes de la generacion anterior en un solo paso,
+    //     x += sum_j beta_j * (x_j - x) / max(1, sum_j beta_j),
+    // acotado a [0, 1]; el divisor hace que x siga dentro de la envolvente convexa de las
+    // posiciones cuando los atractivos suman mas de 1. Despues se aplica un movimiento aleatorio,
+    // que no se revierte, y toda la generacion se evalua una vez con evaluarGeneracion.
+    // Como iterarSincrono, el resultado no depende del numero de hilos.
+    void iterarCombinado(int numeroCultivos, int meses, Cultivacion& cultivacion, PoolHilos& pool, int iteracion) {
+        if (almacenamientoContiguo)
+            posicionesAnteriores = posiciones;
+        else
+            generacionAnterior = luciernagas;
+        objetivosAnteriores = valoresObjetivo;
+        asegurarModelo(numeroCultivos, meses, cultivacion);
+        if (modoAtraccion == ATRACCION_VECINOS) {
+            filasIndice.resize(luciernagas.size());
+            for (size_t j = 0; j < luciernagas.size(); ++j) filasIndice[j] = vistaAnterior(j).valores.data();
+            indiceVecinos.construir(filasIndice, dimension(), vecinosAtraccion, semilla, pool);
+        }
+        prepararEspacioHilos(pool.numHilos(), numeroCultivos, meses);
+
+        pool.paraCada(luciernagas.size(), [&](size_t inicio, size_t fin, int hilo) {
+            for (size_t i = inicio; i < fin; ++i) {
+                GeneradorAleatorio generadorLuciernaga(semilla, flujoSincrono(iteracion, i));
+                moverCombinado(i, generadorLuciernaga, espaciosTrabajo[hilo]);
+            }
+        });
+        evaluarGeneracion(numeroCultivos, meses, cultivacion, pool);
+    }
+
+    void moverCombinado(size_t i, GeneradorAleatorio& generador, EspacioTrabajo& espacio) {
+        VistaLuciernaga luciernaga = vista(i);
+        size_t dim = luciernaga.valores.size();
+
+        // Companeras mas brillantes y sus distancias al cuadrado; los atractivos se calculan de una vez
+        vector<size_t>& brillantes = espacio.companeras;
+        brillantes.clear();
+        size_t numCompaneras = prepararCompaneras(i, espacio);
+        for (size_t c = 0; c < numCompaneras; ++c) {
+            size_t j = companera(c, espacio);
+            if (j == i || !(objetivosAnteriores[j] > objetivosAnteriores[i])) continue;
+            espacio.distanciasCompaneras[brillantes.size()] =
+                KernelsSimd::distanciaCuadrada(luciernaga.valores.data(), vistaAnterior(j).valores.data(), dim);
+            brillantes.push_back(j);
+        }
+        calcularAtractivos(espacio.distanciasCompaneras.data(), espacio.betasCompaneras.data(), brillantes.size());
+
+        double* acumulado = espacio.desplazamiento.data();
+        fill(acumulado, acumulado + dim, 0.0);
+        double sumaBetas = 0.0;
+        for (size_t c = 0; c < brillantes.size(); ++c) {
+            double beta = espacio.betasCompaneras[c];
+            if (beta < umbralAtractivo) continue;
+            const double* otra = vistaAnterior(brillantes[c]).valores.data();
+            for (size_t d = 0; d < dim; ++d) acumulado[d] += beta * otra[d];
+            sumaBetas += beta;
+        }
+
+        if (sumaBetas > 0) {
+            double factor = 1.0 / max(1.0, sumaBetas);
+            for (size_t d = 0; d < dim; ++d) {
+                double x = luciernaga.valores[d];
+                luciernaga.valores[d] = max(0.0, min(1.0, x + (acumulado[d] - sumaBetas * x) * factor));
+            }
+        }
+        // En la actualizacion combinada el movimiento aleatorio no se revierte nunca
+        if (movimientoAleatorio(luciernaga, modelo, generador) < modelo.meses) ++movimientosAceptados[i];
+        repararSiActivo(luciernaga, espacio);
     }
 };
 
@@ -0,0 +1,363 @@
+#ifndef ENJAMBREFIJO_H
+#define ENJAMBREFIJO_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+#include "Aleatorio.h"
+#include "Enjambre.h"
+#include "Instrumentacion.h"
+#include "KernelsSimd.h"
+#include "Luciernaga.h"
+#include "ModeloProblema.h"
+#include "RegistroDeshacer.h"
+
+// Enjambre especializado para una forma de problema fija (NumCultivos x Meses). Las posiciones son
+// std::array y todos los bucles sobre cultivos y meses tienen limites constantes, de modo que el
+// compilador los puede desenrollar y vectorizar; los datos del modelo se copian tambien a arrays.
+//
+// Solo implementa la iteracion secuencial del algoritmo original con atraccion entre todas las
+// luciernagas y actualizacion por pareja, que es el caso por defecto. Hace exactamente las mismas
+// operaciones en el mismo orden que Enjambre::iterarSecuencial y consume el generador igual, asi
+// que el resultado es identico bit a bit: se construye a partir de un Enjambre ya inicializado y
+// volcarEn le devuelve el estado para seguir con el (imprimir, guardar un punto de control...).
+template <int NumCultivos, int Meses>
+class EnjambreFijo {
+   public:
+    static const int DIMENSION = NumCultivos * Meses;
+    typedef array<double, DIMENSION> Posicion;
+
+    // Estado al comienzo de cada mes, como TrayectoriaEvaluacion
+    struct Trayectoria {
+        array<double, Meses + 1> aguaInicioMes;
+        array<double, Meses + 1> conductividadInicioMes;
+        array<double, Meses + 1> cosechaAntesMes;
+    };
+
+    double alfa;
+    double beta0;
+    double gamma;
+    double umbralAtractivo;
+    GeneradorAleatorio generador;
+    vector<Posicion> posiciones;
+    vector<double> valoresObjetivo;
+    vector<Trayectoria> trayectorias;
+    vector<unsigned long> evaluacionesLuciernaga;
+    vector<unsigned long> movimientosAceptados;
+    vector<unsigned long> movimientosRevertidos;
+
+    // El enjambre ya tiene que estar inicializado (posiciones, valores y trayectorias) para esta forma
+    explicit EnjambreFijo(Enjambre& enjambre)
+        : alfa(enjambre.alfa), beta0(enjambre.beta0), gamma(enjambre.gamma), umbralAtractivo(enjambre.umbralAtractivo),
+          generador(enjambre.generador) {
+        copiarModelo(enjambre.modelo);
+        registro.reservar(Meses * (Meses + 1) / 2);
+        size_t n = enjambre.valoresObjetivo.size();
+        posiciones.resize(n);
+        trayectorias.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            VistaLuciernaga luciernaga = enjambre.vista(i);
+            copy(luciernaga.valores.begin(), luciernaga.valores.end(), posiciones[i].begin());
+            const TrayectoriaEvaluacion& trayectoria = enjambre.trayectorias[i];
+            copy(trayectoria.aguaInicioMes.begin(), trayectoria.aguaInicioMes.end(), trayectorias[i].aguaInicioMes.begin());
+            copy(trayectoria.conductividadInicioMes.begin(), trayectoria.conductividadInicioMes.end(),
+                 trayectorias[i].conductividadInicioMes.begin());
+            copy(trayectoria.cosechaAntesMes.begin(), trayectoria.cosechaAntesMes.end(), trayectorias[i].cosechaAntesMes.begin());
+        }
+        valoresObjetivo = enjambre.valoresObjetivo;
+        evaluacionesLuciernaga = enjambre.evaluacionesLuciernaga;
+        movimientosAceptados = enjambre.movimientosAceptados;
+        movimientosRevertidos = enjambre.movimientosRevertidos;
+    }
+
+    // Si el enjambre esta en un modo que esta version sabe ejecutar
+    static bool admite(const Enjambre& enjambre) {
+        return enjambre.modoAtraccion == ATRACCION_TODOS && enjambre.modoActualizacion == ACTUALIZACION_POR_PAREJA &&
+               !enjambre.repararFactibilidad && !enjambre.cacheEvaluaciones &&
+               enjambre.modelo.numeroCultivos == NumCultivos && enjambre.modelo.meses == Meses &&
+               static_cast<int>(enjambre.dimension()) == DIMENSION &&
+               enjambre.modelo.aguaInicialDisponible.size() == static_cast<size_t>(Meses);
+    }
+
+    // Devuelve al enjambre las posiciones, valores, trayectorias, contadores y el generador
+    void volcarEn(Enjambre& enjambre) const {
+        for (size_t i = 0; i < posiciones.size(); ++i) {
+            VistaLuciernaga luciernaga = enjambre.vista(i);
+            copy(posiciones[i].begin(), posiciones[i].end(), luciernaga.valores.begin());
+            TrayectoriaEvaluacion& trayectoria = enjambre.trayectorias[i];
+            copy(trayectorias[i].aguaInicioMes.begin(), trayectorias[i].aguaInicioMes.end(), trayectoria.aguaInicioMes.begin());
+            copy(trayectorias[i].conductividadInicioMes.begin(), trayectorias[i].conductividadInicioMes.end(),
+                 trayectoria.conductividadInicioMes.begin());
+            copy(trayectorias[i].cosechaAntesMes.begin(), trayectorias[i].cosechaAntesMes.end(), trayectoria.cosechaAntesMes.begin());
+        }
+        enjambre.valoresObjetivo = valoresObjetivo;
+        for (size_t i = 0; i < posiciones.size(); ++i) enjambre.luciernagas[i].valorObjetivo = valoresObjetivo[i];
+        enjambre.evaluacionesLuciernaga = evaluacionesLuciernaga;
+        enjambre.movimientosAceptados = movimientosAceptados;
+        enjambre.movimientosRevertidos = movimientosRevertidos;
+        enjambre.generador = generador;
+    }
+
+    double funcionObjetivo(const Posicion& posicion) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_FUNCION_OBJETIVO);
+        double cosechaTotal = 0.0;
+        double conductividadElectrica = conductividadInicial;
+        double aguaMes = aguaInicialDisponible[0];
+        for (int mes = 0; mes < Meses; ++mes) {
+            double cosechaMensual = evaluarMes(posicion, mes, aguaMes, conductividadElectrica);
+            cosechaTotal += cosechaMensual;
+        }
+        return cosechaTotal;
+    }
+
+    // Como Enjambre::evaluarDesde
+    double evaluarDesde(const Posicion& posicion, int mesInicio, const Trayectoria& base, Trayectoria& destino) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_EVALUAR_DESDE);
+        double cosechaTotal = 0.0;
+        double conductividadElectrica = conductividadInicial;
+        double aguaMes = aguaInicialDisponible[0];
+        if (mesInicio > 0) {
+            cosechaTotal = base.cosechaAntesMes[mesInicio];
+            conductividadElectrica = base.conductividadInicioMes[mesInicio];
+            aguaMes = base.aguaInicioMes[mesInicio];
+        }
+        for (int mes = mesInicio; mes < Meses; ++mes) {
+            destino.aguaInicioMes[mes] = aguaMes;
+            destino.conductividadInicioMes[mes] = conductividadElectrica;
+            destino.cosechaAntesMes[mes] = cosechaTotal;
+            double cosechaMensual = evaluarMes(posicion, mes, aguaMes, conductividadElectrica);
+            cosechaTotal += cosechaMensual;
+        }
+        destino.aguaInicioMes[Meses] = aguaMes;
+        destino.conductividadInicioMes[Meses] = conductividadElectrica;
+        destino.cosechaAntesMes[Meses] = cosechaTotal;
+        return cosechaTotal;
+    }
+
+    // Como Enjambre::movimientoAleatorio. Devuelve el primer mes modificado, o Meses.
+    int movimientoAleatorio(Posicion& posicion, GeneradorAleatorio& generador, RegistroDeshacer* registro = nullptr) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_MOVIMIENTO_ALEATORIO);
+        int primerMesCambiado = Meses;
+        for (int mes = 0; mes < Meses; ++mes) {
+            int numValidos = inicioValidosMes[mes + 1] - inicioValidosMes[mes];
+            if (numValidos == 0) continue;
+
+            int cultivoSeleccionado = cultivosValidos[inicioValidosMes[mes] + generador.entero(numValidos)];
+            int indice = cultivoSeleccionado + NumCultivos * mes;
+
+            double areaMesActual = 0.0;
+            for (int cultivo = 0; cultivo < NumCultivos; ++cultivo) areaMesActual += posicion[cultivo + NumCultivos * mes];
+
+            double incremento = alfa * (generador.uniforme() - 0.5);
+            double nuevoValor = max(0.0, min(1.0, posicion[indice] + incremento));
+
+            if (areaMesActual - posicion[indice] + nuevoValor > 1.0) continue;
+
+            int periodoCrecimiento = mesesCultivo[cultivoSeleccionado];
+            if (hayAreaMesesSiguientes(posicion, cultivoSeleccionado, mes, periodoCrecimiento, incremento)) {
+                for (int m = 0; m < periodoCrecimiento && (mes + m) < Meses; ++m) {
+                    int celda = cultivoSeleccionado + NumCultivos * (mes + m);
+                    if (registro) registro->anotar(celda, posicion[celda]);
+                    posicion[celda] = max(0.0, min(1.0, posicion[celda] + incremento));
+                }
+                primerMesCambiado = min(primerMesCambiado, mes);
+            }
+        }
+        return primerMesCambiado;
+    }
+
+    double calcularDistancia(const double* posicion1, const double* posicion2) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_CALCULAR_DISTANCIA);
+        return sqrt(KernelsSimd::distanciaCuadradaFija<DIMENSION>(posicion1, posicion2));
+    }
+
+    // Una iteracion de Enjambre::iterarSecuencial (atraccion entre todas, por pareja)
+    void iterarSecuencial() {
+        size_t n = posiciones.size();
+        for (size_t i = 0; i < n; ++i) {
+            Posicion& luciernaga = posiciones[i];
+            for (size_t j = 0; j < n; ++j) {
+                if (i == j) {
+                    movimientoAleatorioConReversion(i);
+                } else if (valoresObjetivo[j] > valoresObjetivo[i]) {
+                    const Posicion& otra = posiciones[j];
+                    double distancia = calcularDistancia(luciernaga.data(), otra.data());
+                    double beta = beta0 * exp(-gamma * pow(distancia, 2));
+                    if (beta < umbralAtractivo) continue;
+
+                    int mesCambio = moverLuciernaga(luciernaga, otra, beta);
+                    if (mesCambio < Meses) {
+                        valoresObjetivo[i] = evaluarDesde(luciernaga, mesCambio, trayectorias[i], trayectorias[i]);
+                        ++evaluacionesLuciernaga[i];
+                    }
+                }
+            }
+        }
+    }
+
+    size_t indiceMejorLuciernaga() const {
+        size_t mejor = 0;
+        for (size_t i = 1; i < valoresObjetivo.size(); ++i) {
+            if (valoresObjetivo[i] > valoresObjetivo[mejor]) mejor = i;
+        }
+        return mejor;
+    }
+
+    void copiarLuciernaga(size_t i, Luciernaga& destino) const {
+        destino.valores.assign(posiciones[i].begin(), posiciones[i].end());
+        destino.valorObjetivo = valoresObjetivo[i];
+    }
+
+    unsigned long long evaluaciones() const {
+        unsigned long long total = 0;
+        for (size_t i = 0; i < evaluacionesLuciernaga.size(); ++i) total += evaluacionesLuciernaga[i];
+        return total;
+    }
+
+    // Como Enjambre::calcularDiversidad
+    double calcularDiversidad(Luciernaga& centroide) const {
+        size_t n = posiciones.size();
+        centroide.valores.assign(DIMENSION, 0.0);
+        if (n == 0) return 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            for (int d = 0; d < DIMENSION; ++d) centroide.valores[d] += posiciones[i][d];
+        }
+        for (int d = 0; d < DIMENSION; ++d) centroide.valores[d] /= n;
+        double distancias = 0.0;
+        for (size_t i = 0; i < n; ++i) distancias += calcularDistancia(posiciones[i].data(), centroide.valores.data());
+        return distancias / n;
+    }
+
+   private:
+    // Copia de ModeloProblema con tamanos fijos
+    array<int, NumCultivos> mesesCultivo;
+    array<double, NumCultivos> aguaPorArea;
+    array<double, NumCultivos> cosechaMensualPorArea;
+    array<double, NumCultivos> susceptibilidadAgua;
+    array<double, NumCultivos> reduccionPorUnidad;
+    array<double, NumCultivos> salinidadCritica;
+    array<double, NumCultivos> salinidadPorArea;
+    array<double, Meses> aguaInicialDisponible;
+    array<int, Meses + 1> inicioValidosMes;
+    array<int, DIMENSION> cultivosValidos;
+    double conductividadInicial;
+
+    // Memoria del movimiento aleatorio con reversion
+    RegistroDeshacer registro;
+    Trayectoria tentativa;
+
+    void copiarModelo(const ModeloProblema& modelo) {
+        copy(modelo.mesesCultivo.begin(), modelo.mesesCultivo.begin() + NumCultivos, mesesCultivo.begin());
+        copy(modelo.aguaPorArea.begin(), modelo.aguaPorArea.begin() + NumCultivos, aguaPorArea.begin());
+        copy(modelo.cosechaMensualPorArea.begin(), modelo.cosechaMensualPorArea.begin() + NumCultivos, cosechaMensualPorArea.begin());
+        copy(modelo.susceptibilidadAgua.begin(), modelo.susceptibilidadAgua.begin() + NumCultivos, susceptibilidadAgua.begin());
+        copy(modelo.reduccionPorUnidad.begin(), modelo.reduccionPorUnidad.begin() + NumCultivos, reduccionPorUnidad.begin());
+        copy(modelo.salinidadCritica.begin(), modelo.salinidadCritica.begin() + NumCultivos, salinidadCritica.begin());
+        copy(modelo.salinidadPorArea.begin(), modelo.salinidadPorArea.begin() + NumCultivos, salinidadPorArea.begin());
+        copy(modelo.aguaInicialDisponible.begin(), modelo.aguaInicialDisponible.begin() + Meses, aguaInicialDisponible.begin());
+        copy(modelo.inicioValidosMes.begin(), modelo.inicioValidosMes.begin() + Meses + 1, inicioValidosMes.begin());
+        cultivosValidos.fill(0);
+        copy(modelo.cultivosValidos.begin(), modelo.cultivosValidos.end(), cultivosValidos.begin());
+        conductividadInicial = modelo.conductividadElectrica;
+    }
+
+    // Cosecha de un mes; avanza el agua y la conductividad al mes siguiente
+    double evaluarMes(const Posicion& posicion, int mes, double& aguaMes, double& conductividadElectrica) const {
+        const double* areas = posicion.data() + NumCultivos * mes;
+        double aguaTotalRequerida = 0.0;
+        for (int cultivo = 0; cultivo < NumCultivos; ++cultivo) {
+            if (areas[cultivo] > 0) aguaTotalRequerida += aguaPorArea[cultivo] * areas[cultivo];
+        }
+        double coeficienteAgua = aguaTotalRequerida > 0 ? min(1.0, max(0.0, aguaMes / aguaTotalRequerida)) : 1.0;
+
+        double cosechaMensual = 0.0;
+        for (int cultivo = 0; cultivo < NumCultivos; ++cultivo) {
+            double areaAsignada = areas[cultivo];
+            if (areaAsignada <= 0) continue;
+            double cosechaEsperada = cosechaMensualPorArea[cultivo] * areaAsignada;
+            double factorExponente = (coeficienteAgua * susceptibilidadAgua[cultivo]) / areaAsignada;
+            double efectoAgua = 1 - exp(-factorExponente);
+            double impactoSalinidad = reduccionPorUnidad[cultivo] * (conductividadElectrica - salinidadCritica[cultivo]);
+            double efectoSalinidad = min(1.0, max(0.0, 1.0 - impactoSalinidad));
+            cosechaMensual += cosechaEsperada * efectoAgua * efectoSalinidad;
+        }
+
+        if (mes < Meses - 1) {
+            double cambioSalinidad = 0.0;
+            for (int cultivo = 0; cultivo < NumCultivos; ++cultivo) cambioSalinidad += salinidadPorArea[cultivo] * areas[cultivo];
+            conductividadElectrica += cambioSalinidad;
+            aguaMes = aguaInicialDisponible[mes + 1] + max(0.0, aguaMes - aguaTotalRequerida);
+        }
+        return cosechaMensual;
+    }
+
+    bool hayAreaMesesSiguientes(const Posicion& posicion, int cultivoSeleccionado, int mes, int periodoCrecimiento,
+                                double incremento) const {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_VERIFICAR_DISPONIBILIDAD);
+        for (int m = 1; m < periodoCrecimiento && (mes + m) < Meses; ++m) {
+            double areaTotalMes = 0.0;
+            for (int cultivo = 0; cultivo < NumCultivos; ++cultivo) {
+                double area = posicion[cultivo + NumCultivos * (mes + m)];
+                areaTotalMes += cultivo == cultivoSeleccionado ? area + incremento : area;
+            }
+            if (areaTotalMes > 1.0 || areaTotalMes < 0.0) return false;
+        }
+        return true;
+    }
+
+    int moverLuciernaga(Posicion& luciernaga, const Posicion& otra, double beta) {
+        size_t primerIndiceCambiado = KernelsSimd::moverYAcotar(luciernaga.data(), otra.data(), beta, DIMENSION);
+        int primerMesCambiado = static_cast<int>(primerIndiceCambiado / NumCultivos);
+        return min(primerMesCambiado, movimientoAleatorio(luciernaga, generador));
+    }
+
+    void movimientoAleatorioConReversion(size_t i) {
+        Posicion& luciernaga = posiciones[i];
+        registro.limpiar();
+        int mesCambio = movimientoAleatorio(luciernaga, generador, &registro);
+        if (mesCambio >= Meses) return;
+
+        double nuevoValor = evaluarDesde(luciernaga, mesCambio, trayectorias[i], tentativa);
+        ++evaluacionesLuciernaga[i];
+        if (nuevoValor < valoresObjetivo[i]) {
+            registro.deshacer(luciernaga.data());
+            ++movimientosRevertidos[i];
+        } else {
+            for (int mes = mesCambio; mes <= Meses; ++mes) {
+                trayectorias[i].aguaInicioMes[mes] = tentativa.aguaInicioMes[mes];
+                trayectorias[i].conductividadInicioMes[mes] = tentativa.conductividadInicioMes[mes];
+                trayectorias[i].cosechaAntesMes[mes] = tentativa.cosechaAntesMes[mes];
+            }
+            valoresObjetivo[i] = nuevoValor;
+            ++movimientosAceptados[i];
+        }
+    }
+};
+
+// Formas con version especializada. Para anadir una basta con una linea mas.
+#define ALGORITMOFA_FORMAS_FIJAS(FORMA) \
+    FORMA(5, 8)                         \
+    FORMA(5, 12)                        \
+    FORMA(10, 12)                       \
+    FORMA(20, 12)                       \
+    FORMA(10, 24)                       \
+    FORMA(20, 24)
+
+// Si hay una version especializada para esa forma devuelve accion.template ejecutar<NumCultivos,
+// Meses>(), que a su vez puede devolver false si no admite el caso; si no la hay, devuelve false.
+// Con false el llamador sigue con el Enjambre dinamico.
+template <class Accion>
+bool despacharFormaFija(int numeroCultivos, int meses, Accion& accion) {
+#define ALGORITMOFA_DESPACHAR_FORMA(C, M) \
+    if (numeroCultivos == (C) && meses == (M)) return accion.template ejecutar<(C), (M)>();
+    ALGORITMOFA_FORMAS_FIJAS(ALGORITMOFA_DESPACHAR_FORMA)
+#undef ALGORITMOFA_DESPACHAR_FORMA
+    return false;
+}
+
+#endif /* ENJAMBREFIJO_H */
@@ -0,0 +1,103 @@
+#ifndef ENJAMBREMULTIOBJETIVO_H
+#define ENJAMBREMULTIOBJETIVO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+#include "ArchivoPareto.h"
+#include "Cultivacion.h"
+#include "Enjambre.h"
+#include "Objetivos.h"
+
+// Variante multiobjetivo del algoritmo de luciernagas (MOFA, Yang 2013) que busca a la vez mucha
+// cosecha, poca agua y poca salinidad final. Las posiciones, los parametros y los operadores de
+// movimiento son los de un Enjambre; cambia el criterio de brillo: una luciernaga se mueve hacia
+// cada companera que la domina, y la que no esta dominada por ninguna da un paso aleatorio que se
+// revierte si la posicion nueva queda dominada por la anterior. Cada posicion se evalua con
+// funcionObjetivos (una pasada para los tres objetivos) y se ofrece a 'archivo', que al terminar
+// tiene el frente de compromisos de toda la ejecucion.
+//
+// Solo hay iteracion secuencial y evaluacion completa: la trayectoria de evaluarDesde solo guarda
+// la cosecha. valoresObjetivo del enjambre contiene la cosecha de cada luciernaga.
+class EnjambreMultiobjetivo {
+   public:
+    Enjambre enjambre;            // Posiciones, parametros y operadores
+    vector<Objetivos> objetivos;  // Objetivos vigentes de cada luciernaga
+    ArchivoPareto archivo;
+
+    EnjambreMultiobjetivo(int numLuciernagas, int dimension, uint64_t semilla, size_t capacidadArchivo)
+        : enjambre(numLuciernagas, dimension, semilla), archivo(capacidadArchivo) {}
+
+    void inicializar(int numeroCultivos, int meses, Cultivacion& cultivacion) {
+        enjambre.inicializarLuciernagas(numeroCultivos, meses, cultivacion);
+        enjambre.prepararEspacioHilos(1, numeroCultivos, meses);
+        objetivos.assign(enjambre.luciernagas.size(), Objetivos());
+        archivo.limpiar();
+        evaluacionesHechas = 0;
+        for (size_t i = 0; i < enjambre.luciernagas.size(); ++i) evaluar(i);
+    }
+
+    // Una iteracion (actualizacion Gauss-Seidel, como Enjambre::iterarSecuencial)
+    void iterar(int numeroCultivos, int meses, Cultivacion& cultivacion) {
+        enjambre.asegurarModelo(numeroCultivos, meses, cultivacion);
+        enjambre.prepararEspacioHilos(1, numeroCultivos, meses);
+        EspacioTrabajo& espacio = enjambre.espaciosTrabajo[0];
+        for (size_t i = 0; i < enjambre.luciernagas.size(); ++i) {
+            VistaLuciernaga luciernaga = enjambre.vista(i);
+            bool dominada = false;
+            for (size_t j = 0; j < enjambre.luciernagas.size(); ++j) {
+                if (j == i || !Objetivos::domina(objetivos[j], objetivos[i])) continue;
+                dominada = true;
+                VistaLuciernaga otra = enjambre.vista(j);
+                double beta = enjambre.calcularAtractivo(enjambre.calcularDistancia(luciernaga, otra));
+                if (beta < enjambre.umbralAtractivo) continue;
+
+                enjambre.moverLuciernaga(luciernaga, otra, beta, enjambre.modelo, enjambre.generador);
+                enjambre.repararSiActivo(luciernaga, espacio);
+                evaluar(i);
+            }
+            if (!dominada) movimientoAleatorioConReversion(i, espacio);
+        }
+    }
+
+    unsigned long long evaluaciones() const { return evaluacionesHechas; }
+
+    // Mayor cosecha del archivo, que sirve de valor de referencia a los criterios de parada
+    double mejorCosecha() const { return archivo.tamano() > 0 ? archivo.objetivos(0).cosecha : 0.0; }
+
+   private:
+    unsigned long long evaluacionesHechas = 0;
+
+    void evaluar(size_t i) {
+        VistaLuciernaga luciernaga = enjambre.vista(i);
+        objetivos[i] = enjambre.funcionObjetivos(luciernaga, enjambre.modelo);
+        luciernaga.valorObjetivo = objetivos[i].cosecha;
+        ++evaluacionesHechas;
+        archivo.insertar(objetivos[i], luciernaga.valores.data(), luciernaga.valores.size());
+    }
+
+    void movimientoAleatorioConReversion(size_t i, EspacioTrabajo& espacio) {
+        VistaLuciernaga luciernaga = enjambre.vista(i);
+        RegistroDeshacer& registro = espacio.registro;
+        registro.limpiar();
+        int mesCambio = enjambre.movimientoAleatorio(luciernaga, enjambre.modelo, enjambre.generador, &registro);
+        mesCambio = min(mesCambio, enjambre.repararSiActivo(luciernaga, espacio, &registro));
+        if (mesCambio >= enjambre.modelo.meses) return;
+
+        Objetivos anteriores = objetivos[i];
+        Objetivos nuevos = enjambre.funcionObjetivos(luciernaga, enjambre.modelo);
+        ++evaluacionesHechas;
+        if (Objetivos::domina(anteriores, nuevos)) {
+            registro.deshacer(luciernaga.valores.data());
+            return;
+        }
+        objetivos[i] = nuevos;
+        luciernaga.valorObjetivo = nuevos.cosecha;
+        archivo.insertar(nuevos, luciernaga.valores.data(), luciernaga.valores.size());
+    }
+};
+
+#endif /* ENJAMBREMULTIOBJETIVO_H */
@@ -0,0 +1,64 @@
+#ifndef ESPACIOTRABAJO_H
+#define ESPACIOTRABAJO_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+#include "RegistroDeshacer.h"
+#include "ReparacionFactibilidad.h"
+#include "TrayectoriaEvaluacion.h"
+
+// Memoria temporal de un hilo de trabajo: todo lo que el bucle interno necesita para probar y
+// revertir movimientos. Enjambre guarda uno por hilo y lo dimensiona con preparar() antes de cada
+// iteracion; como solo crece, a partir de la primera iteracion el bucle no pide memoria.
+class EspacioTrabajo {
+   public:
+    TrayectoriaEvaluacion trayectoriaTentativa;  // Evaluacion de un movimiento que puede revertirse
+    RegistroDeshacer registro;                   // Celdas cambiadas por el movimiento, para revertirlo
+    ReparacionFactibilidad reparacion;           // Memoria de la reparacion (Enjambre::repararFactibilidad)
+    vector<double> desplazamiento;               // Atraccion acumulada de la actualizacion combinada
+    vector<pair<double, size_t> > candidatosVecinos;  // Candidatos de IndiceVecinos::buscar con su distancia
+    vector<size_t> vecinos;                           // Companeras de la luciernaga en curso
+    vector<size_t> companeras;                        // Companeras mas brillantes (actualizacion combinada)
+    vector<double> distanciasCompaneras;              // Su distancia al cuadrado
+    vector<double> betasCompaneras;                   // Su atractivo
+
+    void preparar(int meses, size_t dimension, size_t maxCandidatos = 0, size_t maxCompaneras = 0) {
+        if (trayectoriaTentativa.aguaInicioMes.size() < static_cast<size_t>(meses + 1)) {
+            ++reservas();
+            trayectoriaTentativa.redimensionar(meses);
+        }
+        if (desplazamiento.size() < dimension) {
+            ++reservas();
+            desplazamiento.resize(dimension);
+        }
+        // Un movimiento aleatorio cambia en el mes m como mucho las celdas de los meses m..meses-1
+        // y la reparacion cada celda una vez
+        if (registro.reservar(static_cast<size_t>(meses) * (meses + 1) / 2 + dimension)) ++reservas();
+        if (meses > 0 && reparacion.preparar(static_cast<int>(dimension / meses), meses)) ++reservas();
+        if (candidatosVecinos.capacity() < maxCandidatos) {
+            ++reservas();
+            candidatosVecinos.reserve(maxCandidatos);
+            vecinos.reserve(maxCandidatos + 1);
+        }
+        if (distanciasCompaneras.size() < maxCompaneras) {
+            ++reservas();
+            companeras.reserve(maxCompaneras);
+            distanciasCompaneras.resize(maxCompaneras);
+            betasCompaneras.resize(maxCompaneras);
+        }
+    }
+
+    // Veces que algun espacio de trabajo tuvo que pedir memoria, sumadas en todo el programa.
+    // Despues de la primera iteracion deberia quedarse quieto.
+    static atomic<unsigned long>& reservas() {
+        static atomic<unsigned long> contador(0);
+        return contador;
+    }
+};
+
+#endif /* ESPACIOTRABAJO_H */
@@ -0,0 +1,217 @@
+#ifndef EVALUADORLOTES_H
+#define EVALUADORLOTES_H
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+#include "Instrumentacion.h"
+#include "ModeloProblema.h"
+#include "KernelsSimd.h"
+#include "TrayectoriaEvaluacion.h"
+
+// Evaluacion de funcionObjetivo para un bloque de luciernagas a la vez. Los meses son el bucle
+// externo (el agua y la salinidad dependen del mes anterior) y cada luciernaga ocupa un carril
+// SIMD: 4 con AVX2 y 8 con AVX-512. Las condiciones 'areaAsignada > 0' se resuelven con mascaras
+// en lugar de saltos y la exponencial es la vectorial de KernelsSimd, asi que el resultado
+// coincide con funcionObjetivo salvo el error de esa exponencial (relativo <= ~1e-15).
+// En el nivel ESCALAR no hay version por lotes: Enjambre usa directamente evaluarDesde.
+class EvaluadorLotes {
+   public:
+    // Numero de luciernagas que se evaluan juntas en el nivel dado (1 si no hay version vectorial)
+    static size_t anchoLote(KernelsSimd::Nivel nivel) {
+        switch (nivel) {
+            case KernelsSimd::AVX512: return 8;
+            case KernelsSimd::AVX2: return 4;
+            default: return 1;
+        }
+    }
+
+    // Evalua hasta anchoLote() filas. 'trayectorias' puede ser nullptr; si no, se rellena la
+    // trayectoria de cada luciernaga como lo haria evaluarDesde con mesInicio = 0. Solo se puede
+    // llamar si el nivel activo tiene version vectorial (anchoLote() > 1).
+    static void evaluar(const double* const* filas, size_t cuenta, double* resultados,
+                        TrayectoriaEvaluacion* const* trayectorias,
+                        const ModeloProblema& modelo) {
+        assert(anchoLote(KernelsSimd::nivelActivo()) > 1);
+        ALGORITMOFA_MEDIR(INSTRUMENTO_EVALUAR_LOTE);
+#ifdef ALGORITMOFA_SIMD_X86
+        switch (KernelsSimd::nivelActivo()) {
+            case KernelsSimd::AVX512:
+                evaluarAvx512(filas, cuenta, resultados, trayectorias, modelo);
+                return;
+            case KernelsSimd::AVX2:
+                evaluarAvx2(filas, cuenta, resultados, trayectorias, modelo);
+                return;
+            default:
+                break;
+        }
+#endif
+        (void)filas; (void)cuenta; (void)resultados; (void)trayectorias;
+        (void)modelo;
+    }
+
+   private:
+    static void guardarTrayectorias(TrayectoriaEvaluacion* const* trayectorias, size_t cuenta, int mes,
+                                    const double* agua, const double* conductividad, const double* cosecha) {
+        if (!trayectorias) return;
+        for (size_t l = 0; l < cuenta; ++l) {
+            trayectorias[l]->aguaInicioMes[mes] = agua[l];
+            trayectorias[l]->conductividadInicioMes[mes] = conductividad[l];
+            trayectorias[l]->cosechaAntesMes[mes] = cosecha[l];
+        }
+    }
+
+#ifdef ALGORITMOFA_SIMD_X86
+    __attribute__((target("avx2"))) static void evaluarAvx2(const double* const* filas, size_t cuenta, double* resultados,
+                                                          TrayectoriaEvaluacion* const* trayectorias,
+                                                          const ModeloProblema& modelo) {
+        // Los carriles sobrantes repiten la ultima fila y sus resultados se descartan
+        const double* f[4];
+        for (size_t l = 0; l < 4; ++l) f[l] = filas[l < cuenta ? l : cuenta - 1];
+
+        const int numeroCultivos = modelo.numeroCultivos;
+        const int meses = modelo.meses;
+        const __m256d cero = _mm256_setzero_pd();
+        const __m256d uno = _mm256_set1_pd(1.0);
+
+        __m256d cosechaTotal = cero;
+        __m256d conductividad = _mm256_set1_pd(modelo.conductividadElectrica);
+        __m256d aguaMes = _mm256_set1_pd(modelo.aguaInicialDisponible[0]);
+        double agua[4], cond[4], cosecha[4];
+
+        for (int mes = 0; mes < meses; ++mes) {
+            if (trayectorias) {
+                _mm256_storeu_pd(agua, aguaMes);
+                _mm256_storeu_pd(cond, conductividad);
+                _mm256_storeu_pd(cosecha, cosechaTotal);
+                guardarTrayectorias(trayectorias, cuenta, mes, agua, cond, cosecha);
+            }
+
+            int base = numeroCultivos * mes;
+            __m256d aguaTotalRequerida = cero;
+            for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+                int indice = base + cultivo;
+                __m256d area = _mm256_set_pd(f[3][indice], f[2][indice], f[1][indice], f[0][indice]);
+                __m256d positiva = _mm256_cmp_pd(area, cero, _CMP_GT_OQ);
+                __m256d aguaCultivo = _mm256_mul_pd(_mm256_set1_pd(modelo.aguaPorArea[cultivo]), area);
+                aguaTotalRequerida = _mm256_add_pd(aguaTotalRequerida, _mm256_and_pd(positiva, aguaCultivo));
+            }
+
+            __m256d hayRequerimiento = _mm256_cmp_pd(aguaTotalRequerida, cero, _CMP_GT_OQ);
+            __m256d cociente = _mm256_max_pd(_mm256_min_pd(_mm256_div_pd(aguaMes, aguaTotalRequerida), uno), cero);
+            __m256d coeficienteAgua = _mm256_blendv_pd(uno, cociente, hayRequerimiento);
+
+            __m256d cosechaMensual = cero;
+            __m256d cambioSalinidad = cero;
+            for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+                int indice = base + cultivo;
+                __m256d area = _mm256_set_pd(f[3][indice], f[2][indice], f[1][indice], f[0][indice]);
+                __m256d positiva = _mm256_cmp_pd(area, cero, _CMP_GT_OQ);
+
+                __m256d cosechaEsperada = _mm256_mul_pd(_mm256_set1_pd(modelo.cosechaMensualPorArea[cultivo]), area);
+                __m256d factorExponente = _mm256_div_pd(_mm256_mul_pd(coeficienteAgua, _mm256_set1_pd(modelo.susceptibilidadAgua[cultivo])), area);
+                __m256d efectoAgua = _mm256_sub_pd(uno, KernelsSimd::expAvx2(_mm256_sub_pd(cero, factorExponente)));
+                __m256d impactoSalinidad = _mm256_mul_pd(_mm256_set1_pd(modelo.reduccionPorUnidad[cultivo]),
+                                                         _mm256_sub_pd(conductividad, _mm256_set1_pd(modelo.salinidadCritica[cultivo])));
+                __m256d efectoSalinidad = _mm256_max_pd(_mm256_min_pd(_mm256_sub_pd(uno, impactoSalinidad), uno), cero);
+                __m256d cosechaReal = _mm256_mul_pd(_mm256_mul_pd(cosechaEsperada, efectoAgua), efectoSalinidad);
+                cosechaMensual = _mm256_add_pd(cosechaMensual, _mm256_and_pd(positiva, cosechaReal));
+
+                cambioSalinidad = _mm256_add_pd(cambioSalinidad, _mm256_mul_pd(_mm256_set1_pd(modelo.salinidadPorArea[cultivo]), area));
+            }
+
+            if (mes < meses - 1) {
+                conductividad = _mm256_add_pd(conductividad, cambioSalinidad);
+                __m256d sobrante = _mm256_max_pd(_mm256_sub_pd(aguaMes, aguaTotalRequerida), cero);
+                aguaMes = _mm256_add_pd(_mm256_set1_pd(modelo.aguaInicialDisponible[mes + 1]), sobrante);
+            }
+            cosechaTotal = _mm256_add_pd(cosechaTotal, cosechaMensual);
+        }
+
+        _mm256_storeu_pd(agua, aguaMes);
+        _mm256_storeu_pd(cond, conductividad);
+        _mm256_storeu_pd(cosecha, cosechaTotal);
+        guardarTrayectorias(trayectorias, cuenta, meses, agua, cond, cosecha);
+        for (size_t l = 0; l < cuenta; ++l) resultados[l] = cosecha[l];
+    }
+
+    __attribute__((target("avx512f"))) static void evaluarAvx512(const double* const* filas, size_t cuenta, double* resultados,
+                                                               TrayectoriaEvaluacion* const* trayectorias,
+                                                               const ModeloProblema& modelo) {
+        const double* f[8];
+        for (size_t l = 0; l < 8; ++l) f[l] = filas[l < cuenta ? l : cuenta - 1];
+
+        const int numeroCultivos = modelo.numeroCultivos;
+        const int meses = modelo.meses;
+        const __m512d cero = _mm512_setzero_pd();
+        const __m512d uno = _mm512_set1_pd(1.0);
+
+        __m512d cosechaTotal = cero;
+        __m512d conductividad = _mm512_set1_pd(modelo.conductividadElectrica);
+        __m512d aguaMes = _mm512_set1_pd(modelo.aguaInicialDisponible[0]);
+        double agua[8], cond[8], cosecha[8];
+
+        for (int mes = 0; mes < meses; ++mes) {
+            if (trayectorias) {
+                _mm512_storeu_pd(agua, aguaMes);
+                _mm512_storeu_pd(cond, conductividad);
+                _mm512_storeu_pd(cosecha, cosechaTotal);
+                guardarTrayectorias(trayectorias, cuenta, mes, agua, cond, cosecha);
+            }
+
+            int base = numeroCultivos * mes;
+            __m512d aguaTotalRequerida = cero;
+            for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+                int indice = base + cultivo;
+                __m512d area = _mm512_set_pd(f[7][indice], f[6][indice], f[5][indice], f[4][indice],
+                                             f[3][indice], f[2][indice], f[1][indice], f[0][indice]);
+                __mmask8 positiva = _mm512_cmp_pd_mask(area, cero, _CMP_GT_OQ);
+                __m512d aguaCultivo = _mm512_mul_pd(_mm512_set1_pd(modelo.aguaPorArea[cultivo]), area);
+                aguaTotalRequerida = _mm512_mask_add_pd(aguaTotalRequerida, positiva, aguaTotalRequerida, aguaCultivo);
+            }
+
+            __mmask8 hayRequerimiento = _mm512_cmp_pd_mask(aguaTotalRequerida, cero, _CMP_GT_OQ);
+            __m512d cociente = _mm512_max_pd(_mm512_min_pd(_mm512_div_pd(aguaMes, aguaTotalRequerida), uno), cero);
+            __m512d coeficienteAgua = _mm512_mask_blend_pd(hayRequerimiento, uno, cociente);
+
+            __m512d cosechaMensual = cero;
+            __m512d cambioSalinidad = cero;
+            for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+                int indice = base + cultivo;
+                __m512d area = _mm512_set_pd(f[7][indice], f[6][indice], f[5][indice], f[4][indice],
+                                             f[3][indice], f[2][indice], f[1][indice], f[0][indice]);
+                __mmask8 positiva = _mm512_cmp_pd_mask(area, cero, _CMP_GT_OQ);
+
+                __m512d cosechaEsperada = _mm512_mul_pd(_mm512_set1_pd(modelo.cosechaMensualPorArea[cultivo]), area);
+                __m512d factorExponente = _mm512_div_pd(_mm512_mul_pd(coeficienteAgua, _mm512_set1_pd(modelo.susceptibilidadAgua[cultivo])), area);
+                __m512d efectoAgua = _mm512_sub_pd(uno, KernelsSimd::expAvx512(_mm512_sub_pd(cero, factorExponente)));
+                __m512d impactoSalinidad = _mm512_mul_pd(_mm512_set1_pd(modelo.reduccionPorUnidad[cultivo]),
+                                                         _mm512_sub_pd(conductividad, _mm512_set1_pd(modelo.salinidadCritica[cultivo])));
+                __m512d efectoSalinidad = _mm512_max_pd(_mm512_min_pd(_mm512_sub_pd(uno, impactoSalinidad), uno), cero);
+                __m512d cosechaReal = _mm512_mul_pd(_mm512_mul_pd(cosechaEsperada, efectoAgua), efectoSalinidad);
+                cosechaMensual = _mm512_mask_add_pd(cosechaMensual, positiva, cosechaMensual, cosechaReal);
+
+                cambioSalinidad = _mm512_add_pd(cambioSalinidad, _mm512_mul_pd(_mm512_set1_pd(modelo.salinidadPorArea[cultivo]), area));
+            }
+
+            if (mes < meses - 1) {
+                conductividad = _mm512_add_pd(conductividad, cambioSalinidad);
+                __m512d sobrante = _mm512_max_pd(_mm512_sub_pd(aguaMes, aguaTotalRequerida), cero);
+                aguaMes = _mm512_add_pd(_mm512_set1_pd(modelo.aguaInicialDisponible[mes + 1]), sobrante);
+            }
+            cosechaTotal = _mm512_add_pd(cosechaTotal, cosechaMensual);
+        }
+
+        _mm512_storeu_pd(agua, aguaMes);
+        _mm512_storeu_pd(cond, conductividad);
+        _mm512_storeu_pd(cosecha, cosechaTotal);
+        guardarTrayectorias(trayectorias, cuenta, meses, agua, cond, cosecha);
+        for (size_t l = 0; l < cuenta; ++l) resultados[l] = cosecha[l];
+    }
+#endif
+};
+
+#endif /* EVALUADORLOTES_H */
@@ -0,0 +1,189 @@
+#ifndef INDICEVECINOS_H
+#define INDICEVECINOS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+#include "Aleatorio.h"
+#include "KernelsSimd.h"
+#include "PoolHilos.h"
+
+// Con que companeras se compara cada luciernaga en una iteracion
+enum ModoAtraccion {
+    ATRACCION_TODOS,   // Todas contra todas, como el algoritmo original: O(n^2) por iteracion
+    ATRACCION_VECINOS  // Solo las k mas cercanas segun IndiceVecinos
+};
+
+// Indice aproximado de vecinos mas cercanos por proyecciones aleatorias (LSH de hiperplanos).
+// Cada tabla asigna a cada fila una clave de 'bits' bits, uno por proyeccion, segun el lado del
+// hiperplano (centrado en el centroide del enjambre) en que cae. Las filas se ordenan por clave,
+// y los candidatos de una consulta son las filas que quedan a menos de 'ventana' puestos de ella
+// en el orden de cada tabla; de esos se quedan las k mas cercanas por distancia exacta.
+// Construirlo cuesta O(n * tablas * bits * dimension) y cada consulta O(tablas * ventana * dimension).
+//
+// Las filas se pasan como punteros y no se copian: deben seguir vivas mientras se consulte.
+class IndiceVecinos {
+   public:
+    int tablas = 4;
+    int bits = 0;  // Bits por tabla; con 0 se elige segun el numero de filas y de vecinos pedidos
+
+    IndiceVecinos() {}
+
+    // Calcula las claves de todas las filas, repartiendo el trabajo en el pool
+    void construir(const vector<const double*>& filas, size_t dimension, size_t vecinos, uint64_t semilla, PoolHilos& pool) {
+        prepararConstruccion(filas, dimension, vecinos, semilla);
+        pool.paraCada(numFilas, [this](size_t inicio, size_t fin, int) { calcularClaves(inicio, fin); });
+        ordenarTablas();
+    }
+
+    void construir(const vector<const double*>& filas, size_t dimension, size_t vecinos, uint64_t semilla) {
+        prepararConstruccion(filas, dimension, vecinos, semilla);
+        calcularClaves(0, numFilas);
+        ordenarTablas();
+    }
+
+    // Hasta k filas (sin contar 'fila') mas cercanas a 'fila' entre los candidatos del indice.
+    // El resultado queda en 'vecinos' junto con la propia 'fila', ordenado por indice.
+    // 'candidatos' y 'vecinos' son memoria temporal del llamador (ver maxCandidatos()).
+    void buscar(size_t fila, size_t k, vector<pair<double, size_t> >& candidatos, vector<size_t>& vecinos) const {
+        candidatos.clear();
+        vecinos.clear();
+        for (int t = 0; t < tablas; ++t) {
+            const uint32_t* orden = &ordenTablas[static_cast<size_t>(t) * numFilas];
+            size_t puesto = puestoTablas[static_cast<size_t>(t) * numFilas + fila];
+            size_t desde = puesto > ventana ? puesto - ventana : 0;
+            size_t hasta = min(numFilas, puesto + ventana + 1);
+            for (size_t q = desde; q < hasta; ++q) {
+                if (orden[q] != fila) candidatos.push_back(make_pair(0.0, static_cast<size_t>(orden[q])));
+            }
+        }
+
+        // Quitar repetidos entre tablas y medir la distancia exacta a cada candidato
+        sort(candidatos.begin(), candidatos.end(), compararIndice);
+        candidatos.erase(unique(candidatos.begin(), candidatos.end(), mismoIndice), candidatos.end());
+        for (size_t c = 0; c < candidatos.size(); ++c) {
+            candidatos[c].first = KernelsSimd::distanciaCuadrada(filas[fila], filas[candidatos[c].second], dimension);
+        }
+        if (candidatos.size() > k) {
+            nth_element(candidatos.begin(), candidatos.begin() + k, candidatos.end());
+            candidatos.resize(k);
+        }
+
+        for (size_t c = 0; c < candidatos.size(); ++c) vecinos.push_back(candidatos[c].second);
+        vecinos.push_back(fila);
+        sort(vecinos.begin(), vecinos.end());
+    }
+
+    // Tamaño maximo de 'candidatos' en buscar(), para reservar la memoria temporal
+    size_t maxCandidatos() const { return static_cast<size_t>(tablas) * (2 * ventana + 1); }
+
+   private:
+    vector<const double*> filas;
+    size_t numFilas = 0;
+    size_t dimension = 0;
+    size_t ventana = 0;
+
+    vector<double> proyecciones;        // tablas * bits vectores de dimension 'dimension'
+    vector<double> desplazamientos;     // Producto del centroide por cada proyeccion
+    vector<double> centroide;
+    vector<uint32_t> claves;            // Clave de cada fila en cada tabla
+    vector<uint32_t> ordenTablas;       // Filas ordenadas por clave, tabla a tabla
+    vector<uint32_t> puestoTablas;      // Posicion de cada fila en ordenTablas
+    uint64_t semillaProyecciones = 0;
+    int bitsProyecciones = -1;
+
+    // Flujo de numeros aleatorios de las proyecciones, distinto de los del enjambre
+    static const uint64_t FLUJO_PROYECCIONES = 5ULL << 61;
+
+    void prepararConstruccion(const vector<const double*>& filasIndice, size_t dimensionFilas, size_t vecinos, uint64_t semilla) {
+        filas = filasIndice;
+        numFilas = filas.size();
+        dimension = dimensionFilas;
+        ventana = max<size_t>(1, vecinos);
+
+        int bitsTabla = bits;
+        if (bitsTabla <= 0) {
+            // Cubetas de unas 2k filas
+            bitsTabla = 1;
+            while (bitsTabla < 24 && (numFilas >> bitsTabla) > 2 * ventana) ++bitsTabla;
+        }
+        size_t numProyecciones = static_cast<size_t>(tablas) * bitsTabla;
+        if (bitsTabla != bitsProyecciones || semilla != semillaProyecciones || proyecciones.size() != numProyecciones * dimension) {
+            generarProyecciones(numProyecciones, semilla);
+            bitsProyecciones = bitsTabla;
+            semillaProyecciones = semilla;
+        }
+
+        // Centroide, para que los hiperplanos corten por el medio del enjambre
+        centroide.assign(dimension, 0.0);
+        for (size_t i = 0; i < numFilas; ++i) {
+            for (size_t d = 0; d < dimension; ++d) centroide[d] += filas[i][d];
+        }
+        for (size_t d = 0; d < dimension; ++d) centroide[d] /= max<size_t>(1, numFilas);
+        desplazamientos.resize(numProyecciones);
+        for (size_t p = 0; p < numProyecciones; ++p) {
+            desplazamientos[p] = productoEscalar(centroide.data(), &proyecciones[p * dimension]);
+        }
+
+        claves.resize(static_cast<size_t>(tablas) * numFilas);
+        ordenTablas.resize(static_cast<size_t>(tablas) * numFilas);
+        puestoTablas.resize(static_cast<size_t>(tablas) * numFilas);
+    }
+
+    void generarProyecciones(size_t numProyecciones, uint64_t semilla) {
+        GeneradorAleatorio generador(semilla, FLUJO_PROYECCIONES);
+        proyecciones.resize(numProyecciones * dimension);
+        // Componentes normales por Box-Muller
+        const double DOS_PI = 6.283185307179586;
+        for (size_t k = 0; k < proyecciones.size(); k += 2) {
+            double radio = sqrt(-2.0 * log(1.0 - generador.uniforme()));
+            double angulo = DOS_PI * generador.uniforme();
+            proyecciones[k] = radio * cos(angulo);
+            if (k + 1 < proyecciones.size()) proyecciones[k + 1] = radio * sin(angulo);
+        }
+    }
+
+    void calcularClaves(size_t inicio, size_t fin) {
+        for (size_t i = inicio; i < fin; ++i) {
+            for (int t = 0; t < tablas; ++t) {
+                uint32_t clave = 0;
+                for (int b = 0; b < bitsProyecciones; ++b) {
+                    size_t p = static_cast<size_t>(t) * bitsProyecciones + b;
+                    if (productoEscalar(filas[i], &proyecciones[p * dimension]) > desplazamientos[p]) clave |= 1u << b;
+                }
+                claves[static_cast<size_t>(t) * numFilas + i] = clave;
+            }
+        }
+    }
+
+    void ordenarTablas() {
+        for (int t = 0; t < tablas; ++t) {
+            uint32_t* orden = &ordenTablas[static_cast<size_t>(t) * numFilas];
+            const uint32_t* clavesTabla = &claves[static_cast<size_t>(t) * numFilas];
+            for (size_t i = 0; i < numFilas; ++i) orden[i] = static_cast<uint32_t>(i);
+            // A igual clave se ordena por indice, para que el resultado sea reproducible
+            sort(orden, orden + numFilas, [clavesTabla](uint32_t a, uint32_t b) {
+                return clavesTabla[a] != clavesTabla[b] ? clavesTabla[a] < clavesTabla[b] : a < b;
+            });
+            for (size_t q = 0; q < numFilas; ++q) puestoTablas[static_cast<size_t>(t) * numFilas + orden[q]] = static_cast<uint32_t>(q);
+        }
+    }
+
+    double productoEscalar(const double* a, const double* b) const {
+        double suma = 0.0;
+        for (size_t d = 0; d < dimension; ++d) suma += a[d] * b[d];
+        return suma;
+    }
+
+    static bool compararIndice(const pair<double, size_t>& a, const pair<double, size_t>& b) { return a.second < b.second; }
+
+    static bool mismoIndice(const pair<double, size_t>& a, const pair<double, size_t>& b) { return a.second == b.second; }
+};
+
+#endif /* INDICEVECINOS_H */
@@ -0,0 +1,300 @@
+#ifndef INSTANCIA_H
+#define INSTANCIA_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "Aleatorio.h"
+#include "Cultivacion.h"
+
+// Un problema completo: la Cultivacion y la forma (cultivos x meses) con la que se resuelve.
+//
+// Formato de archivo (texto): una clave por linea seguida de sus valores, separados por espacios
+// o comas. Las lineas en blanco y lo que sigue a '#' se ignoran. Una clave puede repetirse para
+// partir una lista larga en varias lineas (por ejemplo 'cultivable' una fila por mes).
+//
+//   cultivos 5
+//   meses 8
+//   areaTotalDisponible 100
+//   conductividadElectrica 0.8
+//   mesesCultivo 4, 5, 3, 3, 4                  # uno por cultivo
+//   requerimientoAgua ...                       # uno por cultivo
+//   reduccionRendimiento ...                    # uno por cultivo
+//   salinidadCritica ...                        # uno por cultivo
+//   maxCosechaPorArea ...                       # uno por cultivo
+//   cambioSalinidadPorArea ...                  # uno por cultivo
+//   susceptibilidadAgua ...                     # uno por cultivo
+//   aguaInicialDisponible ...                   # uno por mes
+//   cultivable ...                              # cultivos * meses valores 0/1, mes a mes
+//
+// Los errores de lectura o de validacion se informan con runtime_error indicando el motivo.
+class Instancia {
+   public:
+    int numeroCultivos = 5;
+    int meses = 8;
+    Cultivacion cultivacion;
+
+    // Cultivos x meses como mucho: muy por encima de cualquier instancia real, y lejos de
+    // desbordar los indices int de las luciernagas
+    static const long long DIMENSION_MAXIMA = 1LL << 24;
+
+    Instancia() {}
+
+    Instancia(int numeroCultivos, int meses, const Cultivacion& cultivacion)
+        : numeroCultivos(numeroCultivos), meses(meses), cultivacion(cultivacion) {}
+
+    int dimension() const { return numeroCultivos * meses; }
+
+    static Instancia cargar(const string& ruta) {
+        ifstream archivo(ruta.c_str());
+        if (!archivo) throw runtime_error("No se puede abrir la instancia '" + ruta + "'");
+        try {
+            return leer(archivo);
+        } catch (const runtime_error& e) {
+            throw runtime_error(ruta + ": " + e.what());
+        }
+    }
+
+    static Instancia leer(istream& entrada) {
+        map<string, vector<double> > valores;
+        string linea;
+        int numeroLinea = 0;
+        while (getline(entrada, linea)) {
+            ++numeroLinea;
+            size_t comentario = linea.find('#');
+            if (comentario != string::npos) linea.erase(comentario);
+            replace(linea.begin(), linea.end(), ',', ' ');
+
+            istringstream campos(linea);
+            string clave;
+            if (!(campos >> clave)) continue;
+            if (!esClaveConocida(clave)) {
+                throw runtime_error("linea " + to_string(numeroLinea) + ": clave desconocida '" + clave + "'");
+            }
+            vector<double>& lista = valores[clave];
+            string texto;
+            while (campos >> texto) {
+                char* fin = nullptr;
+                double valor = strtod(texto.c_str(), &fin);
+                if (*fin != '\0' || !std::isfinite(valor)) {
+                    throw runtime_error("linea " + to_string(numeroLinea) + ": valor no valido '" + texto + "' en '" + clave + "'");
+                }
+                lista.push_back(valor);
+            }
+        }
+
+        Instancia instancia;
+        instancia.numeroCultivos = leerEntero(valores, "cultivos");
+        instancia.meses = leerEntero(valores, "meses");
+        if (instancia.numeroCultivos < 1) throw runtime_error("'cultivos' debe ser al menos 1");
+        if (instancia.meses < 1) throw runtime_error("'meses' debe ser al menos 1");
+        comprobarDimension(instancia.numeroCultivos, instancia.meses);
+
+        int nc = instancia.numeroCultivos;
+        int meses = instancia.meses;
+        Cultivacion& c = instancia.cultivacion;
+        c.areaTotalDisponible = leerLista(valores, "areaTotalDisponible", 1)[0];
+        c.conductividadElectrica = leerLista(valores, "conductividadElectrica", 1)[0];
+        c.requerimientoAgua = leerLista(valores, "requerimientoAgua", nc);
+        c.reduccionRendimiento = leerLista(valores, "reduccionRendimiento", nc);
+        c.salinidadCritica = leerLista(valores, "salinidadCritica", nc);
+        c.maxCosechaPorArea = leerLista(valores, "maxCosechaPorArea", nc);
+        c.cambioSalinidadPorArea = leerLista(valores, "cambioSalinidadPorArea", nc);
+        c.susceptibilidadAgua = leerLista(valores, "susceptibilidadAgua", nc);
+        c.aguaInicialDisponible = leerLista(valores, "aguaInicialDisponible", meses);
+        c.mesesCultivo = aEnteros(leerLista(valores, "mesesCultivo", nc), "mesesCultivo");
+        c.cultivable = aEnteros(leerLista(valores, "cultivable", static_cast<size_t>(nc) * meses), "cultivable");
+
+        instancia.validar();
+        return instancia;
+    }
+
+    // Comprueba tamaños y rangos; lanza runtime_error con el primer problema encontrado
+    void validar() const {
+        const Cultivacion& c = cultivacion;
+        comprobarTamano(c.mesesCultivo.size(), numeroCultivos, "mesesCultivo");
+        comprobarTamano(c.requerimientoAgua.size(), numeroCultivos, "requerimientoAgua");
+        comprobarTamano(c.reduccionRendimiento.size(), numeroCultivos, "reduccionRendimiento");
+        comprobarTamano(c.salinidadCritica.size(), numeroCultivos, "salinidadCritica");
+        comprobarTamano(c.maxCosechaPorArea.size(), numeroCultivos, "maxCosechaPorArea");
+        comprobarTamano(c.cambioSalinidadPorArea.size(), numeroCultivos, "cambioSalinidadPorArea");
+        comprobarTamano(c.susceptibilidadAgua.size(), numeroCultivos, "susceptibilidadAgua");
+        comprobarTamano(c.aguaInicialDisponible.size(), meses, "aguaInicialDisponible");
+        comprobarTamano(c.cultivable.size(), static_cast<size_t>(numeroCultivos) * meses, "cultivable");
+
+        if (!(c.areaTotalDisponible > 0)) throw runtime_error("'areaTotalDisponible' debe ser positiva");
+        for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+            if (c.mesesCultivo[cultivo] < 1) throw runtime_error("'mesesCultivo' debe ser al menos 1 (cultivo " + to_string(cultivo) + ")");
+            if (c.requerimientoAgua[cultivo] < 0) throw runtime_error("'requerimientoAgua' no puede ser negativo (cultivo " + to_string(cultivo) + ")");
+            if (c.maxCosechaPorArea[cultivo] < 0) throw runtime_error("'maxCosechaPorArea' no puede ser negativa (cultivo " + to_string(cultivo) + ")");
+            if (c.susceptibilidadAgua[cultivo] < 0) throw runtime_error("'susceptibilidadAgua' no puede ser negativa (cultivo " + to_string(cultivo) + ")");
+        }
+        for (int mes = 0; mes < meses; ++mes) {
+            if (c.aguaInicialDisponible[mes] < 0) throw runtime_error("'aguaInicialDisponible' no puede ser negativa (mes " + to_string(mes) + ")");
+        }
+        for (size_t k = 0; k < c.cultivable.size(); ++k) {
+            if (c.cultivable[k] != 0 && c.cultivable[k] != 1) throw runtime_error("'cultivable' solo admite 0 o 1");
+        }
+    }
+
+    void guardar(const string& ruta) const {
+        ofstream archivo(ruta.c_str());
+        if (!archivo) throw runtime_error("No se puede escribir la instancia '" + ruta + "'");
+        escribir(archivo);
+        if (!archivo) throw runtime_error("Error al escribir la instancia '" + ruta + "'");
+    }
+
+    void escribir(ostream& salida) const {
+        const Cultivacion& c = cultivacion;
+        salida << setprecision(17);
+        salida << "cultivos " << numeroCultivos << "\n";
+        salida << "meses " << meses << "\n";
+        salida << "areaTotalDisponible " << c.areaTotalDisponible << "\n";
+        salida << "conductividadElectrica " << c.conductividadElectrica << "\n";
+        escribirLista(salida, "mesesCultivo", c.mesesCultivo);
+        escribirLista(salida, "requerimientoAgua", c.requerimientoAgua);
+        escribirLista(salida, "reduccionRendimiento", c.reduccionRendimiento);
+        escribirLista(salida, "salinidadCritica", c.salinidadCritica);
+        escribirLista(salida, "maxCosechaPorArea", c.maxCosechaPorArea);
+        escribirLista(salida, "cambioSalinidadPorArea", c.cambioSalinidadPorArea);
+        escribirLista(salida, "susceptibilidadAgua", c.susceptibilidadAgua);
+        escribirLista(salida, "aguaInicialDisponible", c.aguaInicialDisponible);
+        for (int mes = 0; mes < meses; ++mes) {
+            vector<int> fila(c.cultivable.begin() + static_cast<size_t>(numeroCultivos) * mes,
+                             c.cultivable.begin() + static_cast<size_t>(numeroCultivos) * (mes + 1));
+            escribirLista(salida, "cultivable", fila);
+        }
+    }
+
+    // Huella de 64 bits (FNV-1a) del texto de escribir(), que conserva todos los digitos de los
+    // datos: dos instancias con la misma huella son, en la practica, la misma instancia
+    uint64_t huella() const {
+        ostringstream texto;
+        escribir(texto);
+        uint64_t h = 0xcbf29ce484222325ULL;
+        const string& datos = texto.str();
+        for (size_t k = 0; k < datos.size(); ++k) {
+            h ^= static_cast<unsigned char>(datos[k]);
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    // Instancia sintetica del tamaño pedido, con parametros en los mismos rangos que el ejemplo
+    // de Cultivacion. El agua por mes no depende del numero de cultivos porque las areas de un mes
+    // suman como mucho 1. La misma semilla da siempre la misma instancia.
+    static Instancia generar(int numeroCultivos, int meses, uint64_t semilla) {
+        if (numeroCultivos < 1 || meses < 1) throw runtime_error("La instancia generada necesita al menos 1 cultivo y 1 mes");
+        comprobarDimension(numeroCultivos, meses);
+        GeneradorAleatorio generador(semilla, FLUJO_GENERADOR_INSTANCIAS);
+        Instancia instancia;
+        instancia.numeroCultivos = numeroCultivos;
+        instancia.meses = meses;
+        Cultivacion& c = instancia.cultivacion;
+
+        c.mesesCultivo.resize(numeroCultivos);
+        c.requerimientoAgua.resize(numeroCultivos);
+        c.reduccionRendimiento.resize(numeroCultivos);
+        c.salinidadCritica.resize(numeroCultivos);
+        c.maxCosechaPorArea.resize(numeroCultivos);
+        c.cambioSalinidadPorArea.resize(numeroCultivos);
+        c.susceptibilidadAgua.resize(numeroCultivos);
+        for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+            c.mesesCultivo[cultivo] = min(meses, 2 + static_cast<int>(generador.entero(5)));
+            c.requerimientoAgua[cultivo] = entre(generador, 0.8, 1.5);
+            c.reduccionRendimiento[cultivo] = entre(generador, 1.0, 10.0);
+            c.salinidadCritica[cultivo] = entre(generador, 1.0, 4.0);
+            c.maxCosechaPorArea[cultivo] = entre(generador, 0.8, 1.3);
+            c.cambioSalinidadPorArea[cultivo] = entre(generador, -0.03, 0.03);
+            c.susceptibilidadAgua[cultivo] = entre(generador, 2.0, 5.0);
+        }
+
+        c.aguaInicialDisponible.resize(meses);
+        for (int mes = 0; mes < meses; ++mes) {
+            c.aguaInicialDisponible[mes] = entre(generador, 100.0, 150.0);
+        }
+
+        // Aproximadamente una de cada veinte combinaciones cultivo/mes no es cultivable
+        c.cultivable.resize(static_cast<size_t>(numeroCultivos) * meses);
+        for (size_t k = 0; k < c.cultivable.size(); ++k) {
+            c.cultivable[k] = generador.entero(20) == 0 ? 0 : 1;
+        }
+
+        c.areaTotalDisponible = 100.0;
+        c.conductividadElectrica = 0.8;
+        return instancia;
+    }
+
+   private:
+    static const uint64_t FLUJO_GENERADOR_INSTANCIAS = 3ULL << 62;
+
+    static bool esClaveConocida(const string& clave) {
+        static const char* const CLAVES[] = {"cultivos", "meses", "areaTotalDisponible", "conductividadElectrica",
+                                             "mesesCultivo", "requerimientoAgua", "reduccionRendimiento",
+                                             "salinidadCritica", "maxCosechaPorArea", "cambioSalinidadPorArea",
+                                             "susceptibilidadAgua", "aguaInicialDisponible", "cultivable"};
+        for (size_t k = 0; k < sizeof(CLAVES) / sizeof(CLAVES[0]); ++k) {
+            if (clave == CLAVES[k]) return true;
+        }
+        return false;
+    }
+
+    static const vector<double>& leerLista(const map<string, vector<double> >& valores, const string& clave, size_t esperados) {
+        map<string, vector<double> >::const_iterator it = valores.find(clave);
+        if (it == valores.end()) throw runtime_error("falta la clave '" + clave + "'");
+        comprobarTamano(it->second.size(), esperados, clave);
+        return it->second;
+    }
+
+    static void comprobarDimension(int numeroCultivos, int meses) {
+        if (static_cast<long long>(numeroCultivos) * meses > DIMENSION_MAXIMA) {
+            throw runtime_error("cultivos x meses = " + to_string(static_cast<long long>(numeroCultivos) * meses) +
+                                " supera el maximo de " + to_string(DIMENSION_MAXIMA));
+        }
+    }
+
+    static int leerEntero(const map<string, vector<double> >& valores, const string& clave) {
+        return aEnteros(leerLista(valores, clave, 1), clave)[0];
+    }
+
+    static vector<int> aEnteros(const vector<double>& lista, const string& clave) {
+        vector<int> enteros(lista.size());
+        for (size_t k = 0; k < lista.size(); ++k) {
+            if (lista[k] != floor(lista[k]) || fabs(lista[k]) > 1e9) {
+                throw runtime_error("'" + clave + "' solo admite enteros");
+            }
+            enteros[k] = static_cast<int>(lista[k]);
+        }
+        return enteros;
+    }
+
+    static void comprobarTamano(size_t encontrados, size_t esperados, const string& clave) {
+        if (encontrados != esperados) {
+            throw runtime_error("'" + clave + "' tiene " + to_string(encontrados) + " valores y se esperaban " + to_string(esperados));
+        }
+    }
+
+    template <class T>
+    static void escribirLista(ostream& salida, const char* clave, const vector<T>& lista) {
+        salida << clave;
+        for (size_t k = 0; k < lista.size(); ++k) salida << (k == 0 ? " " : ", ") << lista[k];
+        salida << "\n";
+    }
+
+    static double entre(GeneradorAleatorio& generador, double minimo, double maximo) {
+        return minimo + (maximo - minimo) * generador.uniforme();
+    }
+};
+
+#endif /* INSTANCIA_H */
@@ -0,0 +1,195 @@
+#ifndef INSTRUMENTACION_H
+#define INSTRUMENTACION_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(ALGORITMOFA_INSTRUMENTAR) && (defined(__x86_64__) || defined(__i386__))
+#define ALGORITMOFA_INSTRUMENTAR_RDTSC
+#include <x86intrin.h>
+#endif
+
+using namespace std;
+
+// Contadores de llamadas y temporizadores de las funciones calientes, para saber donde se va el
+// tiempo sin un perfilador externo. Solo se activa compilando con -DALGORITMOFA_INSTRUMENTAR; sin
+// esa macro, ALGORITMOFA_MEDIR y ALGORITMOFA_CONTAR no generan codigo.
+//
+// Cada hilo acumula en sus propios contadores (thread_local), sin atomicos ni cerrojos en el
+// camino caliente; resumen() suma los de todos los hilos y debe llamarse con los hilos parados
+// (entre iteraciones o al final). El tiempo se mide con RDTSC en x86 y con steady_clock en otras
+// arquitecturas; los ciclos se pasan a nanosegundos comparando ambos relojes desde el arranque.
+// Los tiempos son inclusivos: verificarDisponibilidadAreaMesesSiguientes esta dentro de
+// movimientoAleatorio, y el coste de medir (unos pocos ns por llamada) va incluido.
+enum PuntoInstrumentado {
+    INSTRUMENTO_FUNCION_OBJETIVO,
+    INSTRUMENTO_EVALUAR_DESDE,
+    INSTRUMENTO_EVALUAR_LOTE,
+    INSTRUMENTO_MOVIMIENTO_ALEATORIO,
+    INSTRUMENTO_VERIFICAR_DISPONIBILIDAD,
+    INSTRUMENTO_CALCULAR_DISTANCIA,
+    INSTRUMENTO_INICIALIZAR,
+    INSTRUMENTO_INICIALIZAR_FACTIBLE,
+    INSTRUMENTO_MUESTRAS_RECHAZADAS,  // Solo contador: intentos descartados en Luciernaga::inicializar
+    INSTRUMENTO_AGUA_INSUFICIENTE,    // Solo contador: esAguaSuficiente devolvio false
+    NUMERO_INSTRUMENTOS
+};
+
+class Instrumentacion {
+   public:
+    struct Contadores {
+        unsigned long long llamadas[NUMERO_INSTRUMENTOS] = {};
+        unsigned long long ticks[NUMERO_INSTRUMENTOS] = {};
+    };
+
+    static bool activo() {
+#ifdef ALGORITMOFA_INSTRUMENTAR
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static const char* nombre(int punto) {
+        static const char* const NOMBRES[NUMERO_INSTRUMENTOS] = {
+            "funcionObjetivo",        "evaluarDesde",
+            "EvaluadorLotes::evaluar", "movimientoAleatorio",
+            "verificarDisponibilidadAreaMesesSiguientes", "calcularDistancia",
+            "Luciernaga::inicializar", "Luciernaga::inicializarFactible",
+            "  muestras rechazadas",   "  esAguaSuficiente fallido"};
+        return NOMBRES[punto];
+    }
+
+    static uint64_t leerReloj() {
+#ifdef ALGORITMOFA_INSTRUMENTAR_RDTSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(Reloj::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Contadores del hilo que llama
+    static Contadores& delHilo() {
+        thread_local RegistroHilo registro;
+        return registro.contadores;
+    }
+
+    // Suma de todos los hilos, vivos o ya terminados
+    static Contadores resumen() {
+        Estado& estado = global();
+        lock_guard<mutex> bloqueo(estado.cerrojo);
+        Contadores total = estado.terminados;
+        for (size_t h = 0; h < estado.hilos.size(); ++h) sumar(total, *estado.hilos[h]);
+        return total;
+    }
+
+    // Tabla con llamadas, tiempo total y tiempo por llamada de cada punto
+    static void imprimirResumen(ostream& salida) {
+        Contadores total = resumen();
+        double nsPorTick = nanosegundosPorTick();
+        char linea[256];
+        snprintf(linea, sizeof(linea), "%-44s %14s %12s %12s", "Funcion", "Llamadas", "Total (ms)", "ns/llamada");
+        salida << linea << "\n";
+        for (int p = 0; p < NUMERO_INSTRUMENTOS; ++p) {
+            if (total.llamadas[p] == 0) continue;
+            if (total.ticks[p] == 0) {
+                snprintf(linea, sizeof(linea), "%-44s %14llu", nombre(p), total.llamadas[p]);
+            } else {
+                double ns = total.ticks[p] * nsPorTick;
+                snprintf(linea, sizeof(linea), "%-44s %14llu %12.3f %12.1f", nombre(p), total.llamadas[p], ns / 1e6,
+                         ns / total.llamadas[p]);
+            }
+            salida << linea << "\n";
+        }
+    }
+
+   private:
+    typedef chrono::steady_clock Reloj;
+
+    struct Estado {
+        mutex cerrojo;
+        vector<Contadores*> hilos;
+        Contadores terminados;
+        Reloj::time_point inicio = Reloj::now();
+        uint64_t ticksInicio = leerReloj();
+    };
+
+    static Estado& global() {
+        static Estado estado;
+        return estado;
+    }
+
+    // Da de alta los contadores del hilo al crearlos y los pasa a 'terminados' cuando el hilo acaba
+    struct RegistroHilo {
+        Contadores contadores;
+
+        RegistroHilo() {
+            Estado& estado = global();
+            lock_guard<mutex> bloqueo(estado.cerrojo);
+            estado.hilos.push_back(&contadores);
+        }
+
+        ~RegistroHilo() {
+            Estado& estado = global();
+            lock_guard<mutex> bloqueo(estado.cerrojo);
+            sumar(estado.terminados, contadores);
+            for (size_t h = 0; h < estado.hilos.size(); ++h) {
+                if (estado.hilos[h] == &contadores) {
+                    estado.hilos.erase(estado.hilos.begin() + h);
+                    break;
+                }
+            }
+        }
+    };
+
+    static void sumar(Contadores& total, const Contadores& parte) {
+        for (int p = 0; p < NUMERO_INSTRUMENTOS; ++p) {
+            total.llamadas[p] += parte.llamadas[p];
+            total.ticks[p] += parte.ticks[p];
+        }
+    }
+
+    static double nanosegundosPorTick() {
+#ifdef ALGORITMOFA_INSTRUMENTAR_RDTSC
+        Estado& estado = global();
+        double ns = chrono::duration<double, nano>(Reloj::now() - estado.inicio).count();
+        uint64_t ticks = leerReloj() - estado.ticksInicio;
+        return ticks > 0 ? ns / ticks : 0.0;
+#else
+        return 1.0;
+#endif
+    }
+};
+
+// Suma una llamada y el tiempo hasta el final del ambito al punto indicado
+class TemporizadorAmbito {
+   public:
+    explicit TemporizadorAmbito(PuntoInstrumentado punto) : punto(punto), inicio(Instrumentacion::leerReloj()) {}
+
+    ~TemporizadorAmbito() {
+        Instrumentacion::Contadores& contadores = Instrumentacion::delHilo();
+        ++contadores.llamadas[punto];
+        contadores.ticks[punto] += Instrumentacion::leerReloj() - inicio;
+    }
+
+   private:
+    PuntoInstrumentado punto;
+    uint64_t inicio;
+};
+
+#define ALGORITMOFA_CONCATENAR_(a, b) a##b
+#define ALGORITMOFA_CONCATENAR(a, b) ALGORITMOFA_CONCATENAR_(a, b)
+
+#ifdef ALGORITMOFA_INSTRUMENTAR
+#define ALGORITMOFA_MEDIR(punto) TemporizadorAmbito ALGORITMOFA_CONCATENAR(temporizador_, __LINE__)(punto)
+#define ALGORITMOFA_CONTAR(punto) (++Instrumentacion::delHilo().llamadas[punto])
+#else
+#define ALGORITMOFA_MEDIR(punto) ((void)0)
+#define ALGORITMOFA_CONTAR(punto) ((void)0)
+#endif
+
+#endif /* INSTRUMENTACION_H */
@@ -0,0 +1,284 @@
+#ifndef KERNELSSIMD_H
+#define KERNELSSIMD_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ALGORITMOFA_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Nucleos vectorizados del bucle de atraccion: distancia al cuadrado, paso de atraccion con
+// acotamiento a [0, 1] y atractivo de una fila de companeras. Cada operacion tiene una version
+// escalar y, en x86 con GCC/Clang, versiones AVX2 y AVX-512 elegidas al arrancar segun la CPU.
+//
+// Tolerancias respecto a la version escalar:
+//  - moverYAcotar es identico bit a bit (mismas operaciones, sin FMA, en el mismo orden por elemento).
+//  - distanciaCuadrada suma en 4 u 8 acumuladores parciales; el error relativo es <= n * 2^-53.
+//  - atractivos usa una exponencial polinomica con error relativo <= 4e-16 (2 ulp) y satura
+//    los argumentos menores que -708 al valor de exp(-708) en lugar de devolver un subnormal o 0.
+class KernelsSimd {
+   public:
+    enum Nivel { ESCALAR = 0, AVX2 = 1, AVX512 = 2 };
+
+    // Mejor nivel que soporta la CPU en la que se ejecuta el programa
+    static Nivel nivelDisponible() {
+#ifdef ALGORITMOFA_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return AVX512;
+        if (__builtin_cpu_supports("avx2")) return AVX2;
+#endif
+        return ESCALAR;
+    }
+
+    // Nivel en uso. Se fija antes de lanzar hilos; por defecto el mejor disponible.
+    static Nivel& nivelActivo() {
+        static Nivel nivel = nivelDisponible();
+        return nivel;
+    }
+
+    static void fijarNivel(Nivel nivel) { nivelActivo() = min(nivel, nivelDisponible()); }
+
+    static const char* nombreNivel(Nivel nivel) {
+        switch (nivel) {
+            case AVX512: return "avx512";
+            case AVX2: return "avx2";
+            default: return "escalar";
+        }
+    }
+
+    // Suma de (b[i] - a[i])^2
+    static double distanciaCuadrada(const double* a, const double* b, size_t n) {
+#ifdef ALGORITMOFA_SIMD_X86
+        switch (nivelActivo()) {
+            case AVX512: return distanciaCuadradaAvx512(a, b, n);
+            case AVX2: return distanciaCuadradaAvx2(a, b, n);
+            default: break;
+        }
+#endif
+        return distanciaCuadradaEscalar(a, b, n);
+    }
+
+    // x[i] = max(0, min(1, x[i] + beta * (y[i] - x[i]))). Devuelve el primer indice que cambio, o n.
+    static size_t moverYAcotar(double* x, const double* y, double beta, size_t n) {
+#ifdef ALGORITMOFA_SIMD_X86
+        switch (nivelActivo()) {
+            case AVX512: return moverYAcotarAvx512(x, y, beta, n);
+            case AVX2: return moverYAcotarAvx2(x, y, beta, n);
+            default: break;
+        }
+#endif
+        return moverYAcotarEscalar(x, y, beta, 0, n, n);
+    }
+
+    // betas[k] = beta0 * exp(-gamma * distanciasCuadradas[k]) para una fila entera de companeras
+    static void atractivos(const double* distanciasCuadradas, double* betas, size_t n, double beta0, double gamma) {
+#ifdef ALGORITMOFA_SIMD_X86
+        switch (nivelActivo()) {
+            case AVX512: atractivosAvx512(distanciasCuadradas, betas, n, beta0, gamma); return;
+            case AVX2: atractivosAvx2(distanciasCuadradas, betas, n, beta0, gamma); return;
+            default: break;
+        }
+#endif
+        atractivosEscalar(distanciasCuadradas, betas, 0, n, beta0, gamma);
+    }
+
+    // distanciaCuadrada con n fijo en tiempo de compilacion, para que el compilador desenrolle el
+    // bucle. Con AVX2 reparte las sumas en los mismos 4 acumuladores que el kernel y los reduce en
+    // el mismo orden, asi que da los mismos bits. Con AVX-512 usa el kernel: el compilador funde
+    // ahi producto y suma (FMA) y el bucle escalar no puede reproducir ese redondeo.
+    template <size_t N>
+    static double distanciaCuadradaFija(const double* a, const double* b) {
+#ifdef ALGORITMOFA_SIMD_X86
+        switch (nivelActivo()) {
+            case AVX512:
+                return distanciaCuadradaAvx512(a, b, N);
+            case AVX2: {
+                const size_t completos = N / 4 * 4;
+                double parciales[4] = {};
+                for (size_t i = 0; i < completos; ++i) {
+                    double diferencia = b[i] - a[i];
+                    parciales[i % 4] += diferencia * diferencia;
+                }
+                double total = (parciales[0] + parciales[1]) + (parciales[2] + parciales[3]);
+                return total + distanciaCuadradaEscalar(a + completos, b + completos, N - completos);
+            }
+            default:
+                break;
+        }
+#endif
+        return distanciaCuadradaEscalar(a, b, N);
+    }
+
+    static double distanciaCuadradaEscalar(const double* a, const double* b, size_t n) {
+        double suma = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double diferencia = b[i] - a[i];
+            suma += diferencia * diferencia;
+        }
+        return suma;
+    }
+
+    static size_t moverYAcotarEscalar(double* x, const double* y, double beta, size_t inicio, size_t n, size_t primero) {
+        for (size_t i = inicio; i < n; ++i) {
+            double anterior = x[i];
+            double nuevo = anterior + beta * (y[i] - anterior);
+            nuevo = max(0.0, min(1.0, nuevo));
+            x[i] = nuevo;
+            if (nuevo != anterior && primero == n) primero = i;
+        }
+        return primero;
+    }
+
+    static void atractivosEscalar(const double* distanciasCuadradas, double* betas, size_t inicio, size_t n,
+                                  double beta0, double gamma) {
+        for (size_t k = inicio; k < n; ++k) {
+            betas[k] = beta0 * exp(-gamma * distanciasCuadradas[k]);
+        }
+    }
+
+#ifdef ALGORITMOFA_SIMD_X86
+    // Coeficientes 1/k! del polinomio de Taylor de grado 13 para e^r con |r| <= ln(2)/2
+    static const double* coeficientesExp() {
+        static const double COEFICIENTES[14] = {
+            1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320,
+            1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600, 1.0 / 6227020800.0};
+        return COEFICIENTES;
+    }
+
+    __attribute__((target("avx2"))) static __m256d expAvx2(__m256d x) {
+        const double* c = coeficientesExp();
+        x = _mm256_max_pd(_mm256_set1_pd(-708.0), _mm256_min_pd(x, _mm256_set1_pd(709.0)));
+        __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634)),
+                                    _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256d r = _mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(6.93147180369123816490e-01)));
+        r = _mm256_sub_pd(r, _mm256_mul_pd(k, _mm256_set1_pd(1.90821492927058770002e-10)));
+        __m256d p = _mm256_set1_pd(c[13]);
+        for (int g = 12; g >= 0; --g) {
+            p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(c[g]));
+        }
+        __m256i exponente = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k));
+        exponente = _mm256_slli_epi64(_mm256_add_epi64(exponente, _mm256_set1_epi64x(1023)), 52);
+        return _mm256_mul_pd(p, _mm256_castsi256_pd(exponente));
+    }
+
+    __attribute__((target("avx512f"))) static __m512d expAvx512(__m512d x) {
+        const double* c = coeficientesExp();
+        x = _mm512_max_pd(_mm512_set1_pd(-708.0), _mm512_min_pd(x, _mm512_set1_pd(709.0)));
+        __m512d k = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(1.4426950408889634)),
+                                         _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m512d r = _mm512_sub_pd(x, _mm512_mul_pd(k, _mm512_set1_pd(6.93147180369123816490e-01)));
+        r = _mm512_sub_pd(r, _mm512_mul_pd(k, _mm512_set1_pd(1.90821492927058770002e-10)));
+        __m512d p = _mm512_set1_pd(c[13]);
+        for (int g = 12; g >= 0; --g) {
+            p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(c[g]));
+        }
+        __m512i exponente = _mm512_cvtepi32_epi64(_mm512_cvtpd_epi32(k));
+        exponente = _mm512_slli_epi64(_mm512_add_epi64(exponente, _mm512_set1_epi64(1023)), 52);
+        return _mm512_mul_pd(p, _mm512_castsi512_pd(exponente));
+    }
+
+    __attribute__((target("avx2"))) static double distanciaCuadradaAvx2(const double* a, const double* b, size_t n) {
+        __m256d suma = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m256d diferencia = _mm256_sub_pd(_mm256_loadu_pd(b + i), _mm256_loadu_pd(a + i));
+            suma = _mm256_add_pd(suma, _mm256_mul_pd(diferencia, diferencia));
+        }
+        double parciales[4];
+        _mm256_storeu_pd(parciales, suma);
+        double total = (parciales[0] + parciales[1]) + (parciales[2] + parciales[3]);
+        return total + distanciaCuadradaEscalar(a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx512f"))) static double distanciaCuadradaAvx512(const double* a, const double* b, size_t n) {
+        __m512d suma = _mm512_setzero_pd();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m512d diferencia = _mm512_sub_pd(_mm512_loadu_pd(b + i), _mm512_loadu_pd(a + i));
+            suma = _mm512_add_pd(suma, _mm512_mul_pd(diferencia, diferencia));
+        }
+        if (i < n) {
+            __mmask8 mascara = static_cast<__mmask8>((1u << (n - i)) - 1);
+            __m512d diferencia = _mm512_sub_pd(_mm512_maskz_loadu_pd(mascara, b + i), _mm512_maskz_loadu_pd(mascara, a + i));
+            suma = _mm512_add_pd(suma, _mm512_mul_pd(diferencia, diferencia));
+        }
+        return _mm512_reduce_add_pd(suma);
+    }
+
+    __attribute__((target("avx2"))) static size_t moverYAcotarAvx2(double* x, const double* y, double beta, size_t n) {
+        const __m256d vbeta = _mm256_set1_pd(beta);
+        const __m256d cero = _mm256_setzero_pd();
+        const __m256d uno = _mm256_set1_pd(1.0);
+        size_t primero = n;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m256d anterior = _mm256_loadu_pd(x + i);
+            __m256d paso = _mm256_mul_pd(vbeta, _mm256_sub_pd(_mm256_loadu_pd(y + i), anterior));
+            // Impide que el compilador fusione el producto y la suma en una FMA (cambiaria el redondeo)
+            __asm__("" : "+v"(paso));
+            __m256d nuevo = _mm256_max_pd(_mm256_min_pd(_mm256_add_pd(anterior, paso), uno), cero);
+            _mm256_storeu_pd(x + i, nuevo);
+            if (primero == n) {
+                int cambios = _mm256_movemask_pd(_mm256_cmp_pd(nuevo, anterior, _CMP_NEQ_UQ));
+                if (cambios) primero = i + __builtin_ctz(cambios);
+            }
+        }
+        return moverYAcotarEscalar(x, y, beta, i, n, primero);
+    }
+
+    __attribute__((target("avx512f"))) static size_t moverYAcotarAvx512(double* x, const double* y, double beta, size_t n) {
+        const __m512d vbeta = _mm512_set1_pd(beta);
+        const __m512d cero = _mm512_setzero_pd();
+        const __m512d uno = _mm512_set1_pd(1.0);
+        size_t primero = n;
+        // El resto se procesa con cargas enmascaradas: con este objetivo el compilador podria
+        // usar FMA en un bucle escalar y el resultado ya no coincidiria con la version escalar
+        for (size_t i = 0; i < n; i += 8) {
+            __mmask8 mascara = n - i >= 8 ? static_cast<__mmask8>(0xff) : static_cast<__mmask8>((1u << (n - i)) - 1);
+            __m512d anterior = _mm512_maskz_loadu_pd(mascara, x + i);
+            __m512d paso = _mm512_mul_pd(vbeta, _mm512_sub_pd(_mm512_maskz_loadu_pd(mascara, y + i), anterior));
+            // Impide que el compilador fusione el producto y la suma en una FMA (cambiaria el redondeo)
+            __asm__("" : "+v"(paso));
+            __m512d nuevo = _mm512_max_pd(_mm512_min_pd(_mm512_add_pd(anterior, paso), uno), cero);
+            _mm512_mask_storeu_pd(x + i, mascara, nuevo);
+            if (primero == n) {
+                __mmask8 cambios = _mm512_mask_cmp_pd_mask(mascara, nuevo, anterior, _CMP_NEQ_UQ);
+                if (cambios) primero = i + __builtin_ctz(cambios);
+            }
+        }
+        return primero;
+    }
+
+    __attribute__((target("avx2"))) static void atractivosAvx2(const double* distanciasCuadradas, double* betas, size_t n,
+                                                             double beta0, double gamma) {
+        const __m256d vbeta0 = _mm256_set1_pd(beta0);
+        const __m256d menosGamma = _mm256_set1_pd(-gamma);
+        size_t k = 0;
+        for (; k + 4 <= n; k += 4) {
+            __m256d argumento = _mm256_mul_pd(menosGamma, _mm256_loadu_pd(distanciasCuadradas + k));
+            _mm256_storeu_pd(betas + k, _mm256_mul_pd(vbeta0, expAvx2(argumento)));
+        }
+        atractivosEscalar(distanciasCuadradas, betas, k, n, beta0, gamma);
+    }
+
+    __attribute__((target("avx512f"))) static void atractivosAvx512(const double* distanciasCuadradas, double* betas, size_t n,
+                                                                  double beta0, double gamma) {
+        const __m512d vbeta0 = _mm512_set1_pd(beta0);
+        const __m512d menosGamma = _mm512_set1_pd(-gamma);
+        size_t k = 0;
+        for (; k + 8 <= n; k += 8) {
+            __m512d argumento = _mm512_mul_pd(menosGamma, _mm512_loadu_pd(distanciasCuadradas + k));
+            _mm512_storeu_pd(betas + k, _mm512_mul_pd(vbeta0, expAvx512(argumento)));
+        }
+        atractivosEscalar(distanciasCuadradas, betas, k, n, beta0, gamma);
+    }
+#endif
+};
+
+#endif /* KERNELSSIMD_H */
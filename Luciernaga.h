@@ -1,6 +1,7 @@
 #ifndef LUCIERNAGA_H
 #define LUCIERNAGA_H
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
@@ -11,6 +12,16 @@
 
 using namespace std;
 
+#include "Aleatorio.h"
+#include "Instrumentacion.h"
+#include "ModeloProblema.h"
+
+// Forma de generar las posiciones iniciales del enjambre
+enum EstrategiaInicializacion {
+    INICIALIZACION_RECHAZO,   // Luciernaga::inicializar: muestreo con rechazo (comportamiento original)
+    INICIALIZACION_FACTIBLE   // Luciernaga::inicializarFactible: muestreo directo, tiempo acotado
+};
+
 class Luciernaga {
    public:
     vector<double> valores;
@@ -27,26 +38,22 @@ class Luciernaga {
         return true;
     }
 
-    static bool debeEntrarEnBucleInicializacion(double areaDisponible) {
+    static bool debeEntrarEnBucleInicializacion(double areaDisponible, GeneradorAleatorio& generador) {
         double resultado = -0.7 * exp(-6 * areaDisponible + 5.25) + 107;
-        return resultado > (rand() % 100);
+        return resultado > generador.entero(100);
     }
 
-    static bool esAguaSuficiente(const vector<double>& aguaDisponible, const vector<double>& requerimientoAgua, int cultivo, int mes, int periodoCrecimiento, double areaUsada, double areaTotalDisponible) {
-        double areaEnHectareas = areaUsada * areaTotalDisponible;
-        random_device rd;
-        mt19937 gen(rd());
-
+    static bool esAguaSuficiente(const vector<double>& aguaDisponible, double aguaRequerida, int mes, int periodoCrecimiento,
+                                 GeneradorAleatorio& generador) {
         for (int m = 0; m < periodoCrecimiento && (mes + m) < aguaDisponible.size(); ++m) {
-            double aguaRequerida = requerimientoAgua[cultivo] * areaEnHectareas;
             double disponible = aguaDisponible[mes + m];
 
             if (disponible < aguaRequerida) {
                 double porcentajeEscasez = (aguaRequerida - disponible) / aguaRequerida;
                 double probabilidadContinuar = 1.0 - porcentajeEscasez;
 
-                uniform_real_distribution<> dis(0.0, 1.0);
-                if (dis(gen) > probabilidadContinuar) {
+                if (generador.uniforme() > probabilidadContinuar) {
+                    ALGORITMOFA_CONTAR(INSTRUMENTO_AGUA_INSUFICIENTE);
                     return false;
                 }
             }
@@ -54,30 +61,32 @@ class Luciernaga {
         return true;
     }
 
-    static Luciernaga inicializar(int dimension, int numeroCultivos, int meses, const vector<int>& mesesCultivo,
-                                  const vector<double>& requerimientoAgua, const vector<int>& cultivable,
-                                  const vector<double>& aguaInicialDisponible, double areaTotalDisponible, double alfa) {
-        Luciernaga luciernaga(dimension);
+    static Luciernaga inicializar(const ModeloProblema& modelo, double alfa, GeneradorAleatorio& generador) {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_INICIALIZAR);
+        int numeroCultivos = modelo.numeroCultivos;
+        int meses = modelo.meses;
+        Luciernaga luciernaga(numeroCultivos * meses);
         vector<double> areaDisponible(meses, 1.0);
-        vector<double> aguaDisponible = aguaInicialDisponible;
+        vector<double> aguaDisponible = modelo.aguaInicialDisponible;
 
-        random_device rd;
-        mt19937 gen(rd());
         chi_squared_distribution<> dist(5);
 
         for (int mes = 0; mes < meses; ++mes) {
-            while (debeEntrarEnBucleInicializacion(areaDisponible[mes])) {
-                int cultivo = rand() % numeroCultivos;
-                int periodoCrecimiento = mesesCultivo[cultivo];
+            while (debeEntrarEnBucleInicializacion(areaDisponible[mes], generador)) {
+                int cultivo = static_cast<int>(generador.entero(numeroCultivos));
+                int periodoCrecimiento = modelo.mesesCultivo[cultivo];
 
-                if (!esCultivable(cultivable, cultivo, mes, periodoCrecimiento, numeroCultivos)) {
+                if (!modelo.esValido(cultivo, mes)) {
+                    ALGORITMOFA_CONTAR(INSTRUMENTO_MUESTRAS_RECHAZADAS);
                     continue;
                 }
 
-                double prcAreaUsada = 8 * dist(gen) / 100.0;
+                double prcAreaUsada = 8 * dist(generador) / 100.0;
                 double areaUsada = (prcAreaUsada > 1 ? 0.0 : prcAreaUsada) * areaDisponible[mes];
+                double aguaRequerida = modelo.aguaPorArea[cultivo] * areaUsada;
 
-                if (!esAguaSuficiente(aguaDisponible, requerimientoAgua, cultivo, mes, periodoCrecimiento, areaUsada, areaTotalDisponible)) {
+                if (!esAguaSuficiente(aguaDisponible, aguaRequerida, mes, periodoCrecimiento, generador)) {
+                    ALGORITMOFA_CONTAR(INSTRUMENTO_MUESTRAS_RECHAZADAS);
                     continue;
                 }
 
@@ -86,8 +95,7 @@ class Luciernaga {
                     luciernaga.valores[indice] += areaUsada;
                     areaDisponible[mes + m] -= areaUsada;
 
-                    double areaEnHectareas = areaUsada * areaTotalDisponible;
-                    double aguaDescontar = requerimientoAgua[cultivo] * areaEnHectareas;
+                    double aguaDescontar = aguaRequerida;
 
                     if (aguaDisponible[mes + m] < aguaDescontar) {
                         aguaDescontar = aguaDisponible[mes + m];
@@ -104,6 +112,72 @@ class Luciernaga {
         return luciernaga;
     }
 
+    // Igual que inicializar, pero muestreando directamente del conjunto factible: el cultivo se
+    // elige entre los validos del mes y el area se recorta a lo que permiten el area libre y el
+    // agua restante en todo su periodo de crecimiento, en lugar de descartar el intento. Cada mes
+    // hace como mucho tantos intentos como cultivos validos tiene, de modo que el coste esta
+    // acotado por dimension * periodo de crecimiento, sin bucles de rechazo.
+    static Luciernaga inicializarFactible(const ModeloProblema& modelo, GeneradorAleatorio& generador) {
+        ALGORITMOFA_MEDIR(INSTRUMENTO_INICIALIZAR_FACTIBLE);
+        int numeroCultivos = modelo.numeroCultivos;
+        int meses = modelo.meses;
+        Luciernaga luciernaga(numeroCultivos * meses);
+        vector<double> areaDisponible(meses, 1.0);
+        vector<double> aguaDisponible = modelo.aguaInicialDisponible;
+
+        for (int mes = 0; mes < meses; ++mes) {
+            const int* validos = modelo.validosMes(mes);
+            int numValidos = modelo.numValidosMes(mes);
+
+            for (int intento = 0; intento < numValidos; ++intento) {
+                if (!debeEntrarEnBucleInicializacion(areaDisponible[mes], generador)) break;
+
+                int cultivo = validos[generador.entero(numValidos)];
+                int periodoCrecimiento = modelo.mesesCultivo[cultivo];
+                int ultimoMes = min(meses, mes + periodoCrecimiento);
+
+                double prcAreaUsada = 8 * chiCuadrado5(generador) / 100.0;
+                double areaUsada = (prcAreaUsada > 1 ? 0.0 : prcAreaUsada) * areaDisponible[mes];
+
+                for (int m = mes; m < ultimoMes; ++m) {
+                    areaUsada = min(areaUsada, areaDisponible[m]);
+                    if (modelo.aguaPorArea[cultivo] > 0) {
+                        areaUsada = min(areaUsada, aguaDisponible[m] / modelo.aguaPorArea[cultivo]);
+                    }
+                }
+                if (areaUsada <= 0) continue;
+
+                double aguaRequerida = modelo.aguaPorArea[cultivo] * areaUsada;
+                for (int m = mes; m < ultimoMes; ++m) {
+                    luciernaga.valores[cultivo + numeroCultivos * m] += areaUsada;
+                    areaDisponible[m] = max(0.0, areaDisponible[m] - areaUsada);
+                    aguaDisponible[m] = max(0.0, aguaDisponible[m] - aguaRequerida);
+                }
+            }
+
+            if (mes < meses - 1) {
+                aguaDisponible[mes + 1] += aguaDisponible[mes];
+            }
+        }
+
+        return luciernaga;
+    }
+
+    // Chi-cuadrado con 5 grados de libertad como suma de 5 normales al cuadrado (Box-Muller),
+    // con un numero fijo de extracciones
+    static double chiCuadrado5(GeneradorAleatorio& generador) {
+        const double DOS_PI = 6.283185307179586;
+        double suma = 0.0;
+        for (int par = 0; par < 3; ++par) {
+            double radio2 = -2.0 * log(1.0 - generador.uniforme());
+            double angulo = DOS_PI * generador.uniforme();
+            double c = cos(angulo);
+            // Las dos normales del par son sqrt(radio2) * cos y sqrt(radio2) * sin
+            suma += par < 2 ? radio2 : radio2 * c * c;
+        }
+        return suma;
+    }
+
     void imprimirLuciernaga(int numeroCultivos) const {
         cout << fixed << setprecision(2);
         cout << "(";
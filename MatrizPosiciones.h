@@ -0,0 +1,85 @@
+#ifndef MATRIZPOSICIONES_H
+#define MATRIZPOSICIONES_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+using namespace std;
+
+// Posiciones de todo el enjambre en un unico bloque contiguo de filas x dimension.
+// Cada fila empieza en una linea de cache (64 bytes) y ocupa un numero entero de lineas,
+// asi que recorrer una luciernaga o copiar la matriz entera no salta por la memoria.
+class MatrizPosiciones {
+   public:
+    static const size_t ALINEACION = 64;
+    static const size_t DOUBLES_POR_LINEA = ALINEACION / sizeof(double);
+
+    MatrizPosiciones() {}
+
+    MatrizPosiciones(size_t filas, size_t dimension) { redimensionar(filas, dimension); }
+
+    MatrizPosiciones(const MatrizPosiciones& otra) { *this = otra; }
+
+    MatrizPosiciones(MatrizPosiciones&& otra) noexcept { intercambiar(otra); }
+
+    MatrizPosiciones& operator=(const MatrizPosiciones& otra) {
+        if (this != &otra) {
+            redimensionar(otra.numFilas, otra.dimensionFila);
+            copy(otra.datos, otra.datos + otra.numFilas * otra.pasoFila, datos);
+        }
+        return *this;
+    }
+
+    MatrizPosiciones& operator=(MatrizPosiciones&& otra) noexcept {
+        intercambiar(otra);
+        return *this;
+    }
+
+    ~MatrizPosiciones() { ::operator delete(bloque); }
+
+    // Cambia la forma de la matriz. Solo pide memoria si la capacidad actual no alcanza.
+    // Las celdas quedan a cero.
+    void redimensionar(size_t filas, size_t dimension) {
+        size_t paso = (dimension + DOUBLES_POR_LINEA - 1) / DOUBLES_POR_LINEA * DOUBLES_POR_LINEA;
+        size_t necesario = filas * paso;
+        if (necesario > capacidad) {
+            ::operator delete(bloque);
+            bloque = ::operator new(necesario * sizeof(double) + ALINEACION);
+            uintptr_t direccion = reinterpret_cast<uintptr_t>(bloque);
+            datos = reinterpret_cast<double*>((direccion + ALINEACION - 1) & ~(uintptr_t)(ALINEACION - 1));
+            capacidad = necesario;
+        }
+        numFilas = filas;
+        dimensionFila = dimension;
+        pasoFila = paso;
+        fill(datos, datos + necesario, 0.0);
+    }
+
+    double* fila(size_t i) { return datos + i * pasoFila; }
+    const double* fila(size_t i) const { return datos + i * pasoFila; }
+
+    size_t filas() const { return numFilas; }
+    size_t dimension() const { return dimensionFila; }
+    size_t paso() const { return pasoFila; }
+
+    void intercambiar(MatrizPosiciones& otra) noexcept {
+        swap(bloque, otra.bloque);
+        swap(datos, otra.datos);
+        swap(numFilas, otra.numFilas);
+        swap(dimensionFila, otra.dimensionFila);
+        swap(pasoFila, otra.pasoFila);
+        swap(capacidad, otra.capacidad);
+    }
+
+   private:
+    void* bloque = nullptr;
+    double* datos = nullptr;
+    size_t numFilas = 0;
+    size_t dimensionFila = 0;
+    size_t pasoFila = 0;
+    size_t capacidad = 0;
+};
+
+#endif /* MATRIZPOSICIONES_H */
@@ -0,0 +1,106 @@
+#ifndef MODELOPROBLEMA_H
+#define MODELOPROBLEMA_H
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+#include "Cultivacion.h"
+
+// Version "compilada" de una Cultivacion para un numero de cultivos y meses dados. Todo lo que
+// solo depende de los datos del problema se calcula una vez aqui: que cultivos pueden empezar en
+// cada mes (como mascara de bits y como lista) y las constantes por cultivo que los operadores
+// usaban recalculando divisiones y productos en cada llamada.
+class ModeloProblema {
+   public:
+    int numeroCultivos = 0;
+    int meses = 0;
+    int palabrasPorMes = 0;                // Palabras de 64 bits por mes en mascaraValidez
+    const Cultivacion* origen = nullptr;   // Cultivacion a partir de la que se compilo
+
+    vector<uint64_t> mascaraValidez;       // Bit 'cultivo' del mes: el cultivo puede empezar ese mes
+    vector<int> inicioValidosMes;          // Cultivos validos del mes m: [inicioValidosMes[m], inicioValidosMes[m + 1])
+    vector<int> cultivosValidos;           // Listas de cultivos validos de todos los meses, una tras otra
+
+    // Constantes por cultivo
+    vector<int> mesesCultivo;              // Periodo de crecimiento
+    vector<double> aguaPorArea;            // requerimientoAgua * areaTotalDisponible
+    vector<double> cosechaMensualPorArea;  // maxCosechaPorArea / mesesCultivo
+    vector<double> susceptibilidadAgua;
+    vector<double> reduccionPorUnidad;     // reduccionRendimiento / 100
+    vector<double> salinidadCritica;
+    vector<double> salinidadPorArea;       // cambioSalinidadPorArea * areaTotalDisponible
+
+    // Datos por mes
+    vector<double> aguaInicialDisponible;
+    double areaTotalDisponible = 0.0;
+    double conductividadElectrica = 0.0;
+
+    ModeloProblema() {}
+
+    ModeloProblema(int numeroCultivos, int meses, const Cultivacion& cultivacion) { compilar(numeroCultivos, meses, cultivacion); }
+
+    void compilar(int numeroCultivos, int meses, const Cultivacion& cultivacion) {
+        this->numeroCultivos = numeroCultivos;
+        this->meses = meses;
+        origen = &cultivacion;
+        palabrasPorMes = (numeroCultivos + 63) / 64;
+
+        mascaraValidez.assign(static_cast<size_t>(meses) * palabrasPorMes, 0);
+        inicioValidosMes.assign(meses + 1, 0);
+        cultivosValidos.clear();
+        int mesesCultivables = static_cast<int>(cultivacion.cultivable.size() / numeroCultivos);
+        for (int mes = 0; mes < meses; ++mes) {
+            inicioValidosMes[mes] = static_cast<int>(cultivosValidos.size());
+            for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+                bool valido = true;
+                for (int m = 0; m < cultivacion.mesesCultivo[cultivo] && (mes + m) < mesesCultivables; ++m) {
+                    if (cultivacion.cultivable[cultivo + numeroCultivos * (mes + m)] == 0) {
+                        valido = false;
+                        break;
+                    }
+                }
+                if (valido) {
+                    mascaraValidez[mes * palabrasPorMes + cultivo / 64] |= 1ULL << (cultivo % 64);
+                    cultivosValidos.push_back(cultivo);
+                }
+            }
+        }
+        inicioValidosMes[meses] = static_cast<int>(cultivosValidos.size());
+
+        mesesCultivo = cultivacion.mesesCultivo;
+        susceptibilidadAgua = cultivacion.susceptibilidadAgua;
+        salinidadCritica = cultivacion.salinidadCritica;
+        aguaPorArea.resize(numeroCultivos);
+        cosechaMensualPorArea.resize(numeroCultivos);
+        reduccionPorUnidad.resize(numeroCultivos);
+        salinidadPorArea.resize(numeroCultivos);
+        for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+            aguaPorArea[cultivo] = cultivacion.requerimientoAgua[cultivo] * cultivacion.areaTotalDisponible;
+            cosechaMensualPorArea[cultivo] = cultivacion.maxCosechaPorArea[cultivo] / cultivacion.mesesCultivo[cultivo];
+            reduccionPorUnidad[cultivo] = cultivacion.reduccionRendimiento[cultivo] / 100.0;
+            salinidadPorArea[cultivo] = cultivacion.cambioSalinidadPorArea[cultivo] * cultivacion.areaTotalDisponible;
+        }
+
+        aguaInicialDisponible = cultivacion.aguaInicialDisponible;
+        areaTotalDisponible = cultivacion.areaTotalDisponible;
+        conductividadElectrica = cultivacion.conductividadElectrica;
+    }
+
+    // Indica si el modelo se compilo para esta Cultivacion y esta forma del problema.
+    // Si se modifican los datos de la Cultivacion hay que volver a compilarlo.
+    bool corresponde(const Cultivacion& cultivacion, int numeroCultivos, int meses) const {
+        return origen == &cultivacion && this->numeroCultivos == numeroCultivos && this->meses == meses;
+    }
+
+    bool esValido(int cultivo, int mes) const {
+        return (mascaraValidez[mes * palabrasPorMes + cultivo / 64] >> (cultivo % 64)) & 1ULL;
+    }
+
+    const int* validosMes(int mes) const { return cultivosValidos.data() + inicioValidosMes[mes]; }
+
+    int numValidosMes(int mes) const { return inicioValidosMes[mes + 1] - inicioValidosMes[mes]; }
+};
+
+#endif /* MODELOPROBLEMA_H */
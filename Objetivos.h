@@ -0,0 +1,25 @@
+#ifndef OBJETIVOS_H
+#define OBJETIVOS_H
+
+using namespace std;
+
+// Los tres objetivos de una posicion, que Enjambre::funcionObjetivos calcula en una sola pasada:
+// la cosecha total (a maximizar), el agua requerida en toda la temporada (suma de la requerida en
+// cada mes) y la conductividad electrica del suelo al terminar el ultimo mes (ambas a minimizar)
+struct Objetivos {
+    double cosecha = 0.0;
+    double agua = 0.0;
+    double salinidad = 0.0;
+
+    // a no es peor que b en ningun objetivo (incluye a == b)
+    static bool cubre(const Objetivos& a, const Objetivos& b) {
+        return a.cosecha >= b.cosecha && a.agua <= b.agua && a.salinidad <= b.salinidad;
+    }
+
+    // a domina a b: no es peor en ningun objetivo y es mejor en alguno
+    static bool domina(const Objetivos& a, const Objetivos& b) {
+        return cubre(a, b) && (a.cosecha > b.cosecha || a.agua < b.agua || a.salinidad < b.salinidad);
+    }
+};
+
+#endif /* OBJETIVOS_H */
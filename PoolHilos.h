@@ -0,0 +1,115 @@
+#ifndef POOLHILOS_H
+#define POOLHILOS_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class PoolHilos {
+   public:
+    explicit PoolHilos(int numHilos) : hilosTotales(numHilos < 1 ? 1 : numHilos) {
+        // El hilo que llama a paraCada trabaja como hilo 0
+        for (int h = 1; h < hilosTotales; ++h) {
+            trabajadores.emplace_back(&PoolHilos::bucleTrabajador, this, h);
+        }
+    }
+
+    ~PoolHilos() {
+        {
+            lock_guard<mutex> bloqueo(mutexTareas);
+            terminar = true;
+        }
+        hayTrabajo.notify_all();
+        for (size_t h = 0; h < trabajadores.size(); ++h) {
+            trabajadores[h].join();
+        }
+    }
+
+    PoolHilos(const PoolHilos&) = delete;
+    PoolHilos& operator=(const PoolHilos&) = delete;
+
+    int numHilos() const { return hilosTotales; }
+
+    // Divide [0, total) en bloques contiguos fijos, uno por hilo, y espera a que terminen.
+    // 'tarea' se llama como tarea(inicio, fin, hilo) para el rango [inicio, fin).
+    // El reparto solo depende de 'total' y del numero de hilos, asi que es reproducible.
+    // La tarea se pasa por referencia sin envolverla en std::function, para no pedir memoria.
+    template <class Tarea>
+    void paraCada(size_t total, Tarea& tarea) {
+        if (hilosTotales == 1 || total < 2) {
+            if (total > 0) tarea(static_cast<size_t>(0), total, 0);
+            return;
+        }
+        {
+            lock_guard<mutex> bloqueo(mutexTareas);
+            contextoTarea = &tarea;
+            invocarTarea = &invocar<Tarea>;
+            totalActual = total;
+            pendientes = hilosTotales - 1;
+            ++generacion;
+        }
+        hayTrabajo.notify_all();
+
+        ejecutarBloque(0);
+
+        unique_lock<mutex> bloqueo(mutexTareas);
+        trabajoTerminado.wait(bloqueo, [this] { return pendientes == 0; });
+        contextoTarea = nullptr;
+    }
+
+    template <class Tarea>
+    void paraCada(size_t total, const Tarea& tarea) {
+        Tarea copia = tarea;
+        paraCada(total, copia);
+    }
+
+   private:
+    int hilosTotales;
+    vector<thread> trabajadores;
+    mutex mutexTareas;
+    condition_variable hayTrabajo;
+    condition_variable trabajoTerminado;
+    void* contextoTarea = nullptr;
+    void (*invocarTarea)(void*, size_t, size_t, int) = nullptr;
+    size_t totalActual = 0;
+    int pendientes = 0;
+    unsigned long generacion = 0;
+    bool terminar = false;
+
+    void ejecutarBloque(int hilo) {
+        size_t inicio = totalActual * hilo / hilosTotales;
+        size_t fin = totalActual * (hilo + 1) / hilosTotales;
+        if (inicio < fin) invocarTarea(contextoTarea, inicio, fin, hilo);
+    }
+
+    template <class Tarea>
+    static void invocar(void* contexto, size_t inicio, size_t fin, int hilo) {
+        (*static_cast<Tarea*>(contexto))(inicio, fin, hilo);
+    }
+
+    void bucleTrabajador(int hilo) {
+        unsigned long generacionVista = 0;
+        while (true) {
+            {
+                unique_lock<mutex> bloqueo(mutexTareas);
+                hayTrabajo.wait(bloqueo, [&] { return terminar || generacion != generacionVista; });
+                if (terminar) return;
+                generacionVista = generacion;
+            }
+
+            ejecutarBloque(hilo);
+
+            {
+                lock_guard<mutex> bloqueo(mutexTareas);
+                --pendientes;
+            }
+            trabajoTerminado.notify_one();
+        }
+    }
+};
+
+#endif /* POOLHILOS_H */
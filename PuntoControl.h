@@ -0,0 +1,337 @@
+#ifndef PUNTOCONTROL_H
+#define PUNTOCONTROL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ALGORITMOFA_ARCHIVOS_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#include "Enjambre.h"
+#include "Instancia.h"
+#include "KernelsSimd.h"
+#include "Luciernaga.h"
+#include "Serializacion.h"
+
+// Archivo de solo lectura proyectado en memoria (mmap). Donde no hay mmap se lee entero.
+class ArchivoMapeado {
+   public:
+    explicit ArchivoMapeado(const string& ruta) {
+#ifdef ALGORITMOFA_ARCHIVOS_POSIX
+        int descriptor = open(ruta.c_str(), O_RDONLY);
+        if (descriptor < 0) throw runtime_error("No se puede abrir '" + ruta + "'");
+        struct stat informacion;
+        if (fstat(descriptor, &informacion) != 0) {
+            close(descriptor);
+            throw runtime_error("No se puede leer '" + ruta + "'");
+        }
+        tamano = static_cast<size_t>(informacion.st_size);
+        if (tamano > 0) {
+            void* mapa = mmap(nullptr, tamano, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapa == MAP_FAILED) {
+                close(descriptor);
+                throw runtime_error("No se puede proyectar en memoria '" + ruta + "'");
+            }
+            proyeccion = mapa;
+            datos = static_cast<const uint8_t*>(mapa);
+        }
+        close(descriptor);
+#else
+        ifstream archivo(ruta.c_str(), ios::binary);
+        if (!archivo) throw runtime_error("No se puede abrir '" + ruta + "'");
+        copia.assign(istreambuf_iterator<char>(archivo), istreambuf_iterator<char>());
+        datos = copia.data();
+        tamano = copia.size();
+#endif
+    }
+
+    ~ArchivoMapeado() {
+#ifdef ALGORITMOFA_ARCHIVOS_POSIX
+        if (proyeccion) munmap(proyeccion, tamano);
+#endif
+    }
+
+    ArchivoMapeado(const ArchivoMapeado&) = delete;
+    ArchivoMapeado& operator=(const ArchivoMapeado&) = delete;
+
+    const uint8_t* datos = nullptr;
+    size_t tamano = 0;
+
+   private:
+    void* proyeccion = nullptr;
+    vector<uint8_t> copia;
+};
+
+// Punto de control de una ejecucion con un Enjambre: todo el estado que hace falta para seguir
+// exactamente donde se quedo. Formato binario (ver Serializacion.h), version 2:
+//
+//   u64 MAGICO, u32 VERSION, u64 huella de la Instancia, i32 cultivos, i32 meses, u32 nivel SIMD
+//   parametros: i32 numLuciernagas, real alfa, real beta0, real gamma, u64 semilla,
+//               u32 estrategiaInicializacion, u32 modoAtraccion, u32 modoActualizacion,
+//               i32 vecinosAtraccion, real umbralAtractivo, u32 almacenamientoContiguo, u32 sincrono,
+//               u32 repararFactibilidad (no esta en la version 1, que se sigue leyendo)
+//   i32 siguiente iteracion, 4 x u64 estado del generador principal, luciernaga mejor hasta ahora
+//   u32 n, u32 dimension, n reales objetivo, n * dimension reales posiciones,
+//   n u64 evaluaciones, n u64 movimientos aleatorios aceptados, n u64 revertidos (los movimientos
+//   no estan en la version 1), n * 3 * (meses + 1) reales trayectorias (agua, conductividad, cosecha)
+//
+// Al leer se comprueba que cada campo este en su rango (enumerados, booleanos, tamanos, reales
+// finitos): un archivo danado da runtime_error en lugar de un enjambre en un modo invalido.
+//
+// Las trayectorias se guardan en lugar de recalcularlas porque la evaluacion por lotes SIMD y la
+// escalar no dan los mismos bits, y de ellas parten las reevaluaciones parciales. Por lo mismo se
+// guarda el nivel SIMD y al reanudar se vuelve a usar: la continuacion solo es identica bit a bit
+// con el mismo nivel (y el mismo binario).
+class PuntoControl {
+   public:
+    static const uint64_t MAGICO = 0x4c52544350414641ULL;  // "AFAPCTRL" en little-endian
+    static const uint32_t VERSION = 2;
+
+    int iteracion = 0;  // Siguiente iteracion a ejecutar
+    bool sincrono = false;
+    Luciernaga mejorLuciernaga{0};
+
+    // Escribe el punto de control en un archivo temporal junto a 'ruta' y lo renombra encima,
+    // de modo que 'ruta' siempre contiene un punto de control completo. 'memoria' se reutiliza.
+    static void guardar(const string& ruta, Enjambre& enjambre, const Instancia& instancia, int iteracion, bool sincrono,
+                        const Luciernaga& mejorLuciernaga, vector<uint8_t>& memoria) {
+        memoria.clear();
+        EscritorBinario escritor(memoria);
+        codificar(escritor, enjambre, instancia, iteracion, sincrono, mejorLuciernaga);
+        escribirAtomicamente(ruta, memoria);
+    }
+
+    // Restaura 'enjambre' (parametros incluidos) desde 'ruta'. La instancia tiene que ser la misma
+    // con la que se guardo; si no, lanza runtime_error.
+    static PuntoControl cargar(const string& ruta, Enjambre& enjambre, const Instancia& instancia) {
+        ArchivoMapeado archivo(ruta);
+        LectorBinario lector(archivo.datos, archivo.tamano);
+        try {
+            return decodificar(lector, enjambre, instancia);
+        } catch (const runtime_error& e) {
+            throw runtime_error("Punto de control '" + ruta + "': " + e.what());
+        }
+    }
+
+    static void codificar(EscritorBinario& escritor, Enjambre& enjambre, const Instancia& instancia, int iteracion,
+                          bool sincrono, const Luciernaga& mejorLuciernaga) {
+        escritor.u64(MAGICO);
+        escritor.u32(VERSION);
+        escritor.u64(instancia.huella());
+        escritor.i32(instancia.numeroCultivos);
+        escritor.i32(instancia.meses);
+        escritor.u32(static_cast<uint32_t>(KernelsSimd::nivelActivo()));
+
+        escritor.i32(enjambre.numLuciernagas);
+        escritor.real(enjambre.alfa);
+        escritor.real(enjambre.beta0);
+        escritor.real(enjambre.gamma);
+        escritor.u64(enjambre.semilla);
+        escritor.u32(static_cast<uint32_t>(enjambre.estrategiaInicializacion));
+        escritor.u32(static_cast<uint32_t>(enjambre.modoAtraccion));
+        escritor.u32(static_cast<uint32_t>(enjambre.modoActualizacion));
+        escritor.i32(enjambre.vecinosAtraccion);
+        escritor.real(enjambre.umbralAtractivo);
+        escritor.u32(enjambre.almacenamientoContiguo ? 1 : 0);
+        escritor.u32(sincrono ? 1 : 0);
+        escritor.u32(enjambre.repararFactibilidad ? 1 : 0);
+
+        escritor.i32(iteracion);
+        for (int k = 0; k < 4; ++k) escritor.u64(enjambre.generador.estado[k]);
+        escritor.luciernaga(mejorLuciernaga);
+
+        size_t n = enjambre.valoresObjetivo.size();
+        size_t dimension = enjambre.dimension();
+        escritor.u32(static_cast<uint32_t>(n));
+        escritor.u32(static_cast<uint32_t>(dimension));
+        escritor.reales(enjambre.valoresObjetivo.data(), n);
+        for (size_t i = 0; i < n; ++i) escritor.reales(enjambre.vista(i).valores.data(), dimension);
+        for (size_t i = 0; i < n; ++i) escritor.u64(enjambre.evaluacionesLuciernaga[i]);
+        for (size_t i = 0; i < n; ++i) escritor.u64(enjambre.movimientosAceptados[i]);
+        for (size_t i = 0; i < n; ++i) escritor.u64(enjambre.movimientosRevertidos[i]);
+        for (size_t i = 0; i < n; ++i) {
+            const TrayectoriaEvaluacion& trayectoria = enjambre.trayectorias[i];
+            escritor.reales(trayectoria.aguaInicioMes.data(), trayectoria.aguaInicioMes.size());
+            escritor.reales(trayectoria.conductividadInicioMes.data(), trayectoria.conductividadInicioMes.size());
+            escritor.reales(trayectoria.cosechaAntesMes.data(), trayectoria.cosechaAntesMes.size());
+        }
+    }
+
+    static PuntoControl decodificar(LectorBinario& lector, Enjambre& enjambre, const Instancia& instancia) {
+        if (lector.u64() != MAGICO) throw runtime_error("no es un punto de control");
+        uint32_t version = lector.u32();
+        if (version < 1 || version > VERSION) throw runtime_error("version " + to_string(version) + " no soportada");
+        if (lector.u64() != instancia.huella()) throw runtime_error("se guardo con otra instancia");
+        int numeroCultivos = lector.i32();
+        int meses = lector.i32();
+        if (numeroCultivos != instancia.numeroCultivos || meses != instancia.meses) {
+            throw runtime_error("se guardo con otra instancia");
+        }
+        KernelsSimd::Nivel nivel = static_cast<KernelsSimd::Nivel>(leerEnumerado(lector, KernelsSimd::AVX512 + 1, "nivel SIMD"));
+        KernelsSimd::fijarNivel(nivel);
+        if (KernelsSimd::nivelActivo() != nivel) {
+            cerr << "Aviso: el punto de control se guardo con SIMD " << KernelsSimd::nombreNivel(nivel)
+                 << ", no disponible aqui; la continuacion puede no ser identica" << endl;
+        }
+
+        PuntoControl punto;
+        int numLuciernagas = lector.i32();
+        if (numLuciernagas < 1) throw runtime_error("numero de luciernagas invalido: " + to_string(numLuciernagas));
+        enjambre.numLuciernagas = numLuciernagas;
+        enjambre.alfa = leerReal(lector, "alfa");
+        enjambre.beta0 = leerReal(lector, "beta0");
+        enjambre.gamma = leerReal(lector, "gamma");
+        enjambre.semilla = lector.u64();
+        enjambre.estrategiaInicializacion =
+            static_cast<EstrategiaInicializacion>(leerEnumerado(lector, INICIALIZACION_FACTIBLE + 1, "estrategia de inicializacion"));
+        enjambre.modoAtraccion = static_cast<ModoAtraccion>(leerEnumerado(lector, ATRACCION_VECINOS + 1, "modo de atraccion"));
+        enjambre.modoActualizacion =
+            static_cast<ModoActualizacion>(leerEnumerado(lector, ACTUALIZACION_COMBINADA + 1, "modo de actualizacion"));
+        enjambre.vecinosAtraccion = lector.i32();
+        if (enjambre.vecinosAtraccion < 1) throw runtime_error("numero de vecinos invalido: " + to_string(enjambre.vecinosAtraccion));
+        enjambre.umbralAtractivo = leerReal(lector, "umbral de atractivo");
+        bool contiguo = leerEnumerado(lector, 2, "almacenamiento contiguo") != 0;
+        punto.sincrono = leerEnumerado(lector, 2, "modo sincrono") != 0;
+        enjambre.repararFactibilidad = version >= 2 && leerEnumerado(lector, 2, "reparacion de factibilidad") != 0;
+
+        punto.iteracion = lector.i32();
+        if (punto.iteracion < 0) throw runtime_error("iteracion invalida: " + to_string(punto.iteracion));
+        for (int k = 0; k < 4; ++k) enjambre.generador.estado[k] = lector.u64();
+        lector.luciernaga(punto.mejorLuciernaga);
+        if (punto.mejorLuciernaga.valores.size() != static_cast<size_t>(instancia.dimension())) {
+            throw runtime_error("dimension incorrecta");
+        }
+
+        size_t n = lector.u32();
+        size_t dimension = lector.u32();
+        if (dimension != static_cast<size_t>(instancia.dimension())) throw runtime_error("dimension incorrecta");
+        if (n != static_cast<size_t>(numLuciernagas)) throw runtime_error("numero de luciernagas incorrecto");
+        // Comprobar el tamaño antes de reservar memoria para n luciernagas
+        size_t trayectoria = static_cast<size_t>(meses) + 1;
+        size_t contadores = version >= 2 ? 3 : 1;
+        if (lector.restantes() / (8 * (1 + contadores + dimension + 3 * trayectoria)) < n) {
+            throw runtime_error("datos binarios truncados");
+        }
+
+        enjambre.asegurarModelo(numeroCultivos, meses, instancia.cultivacion);
+        enjambre.almacenamientoContiguo = false;
+        enjambre.valoresObjetivo.resize(n);
+        lector.reales(enjambre.valoresObjetivo.data(), n);
+        enjambre.luciernagas.assign(n, Luciernaga(static_cast<int>(dimension)));
+        for (size_t i = 0; i < n; ++i) {
+            lector.reales(enjambre.luciernagas[i].valores.data(), dimension);
+            enjambre.luciernagas[i].valorObjetivo = enjambre.valoresObjetivo[i];
+        }
+        enjambre.evaluacionesLuciernaga.clear();
+        enjambre.movimientosAceptados.clear();
+        enjambre.movimientosRevertidos.clear();
+        enjambre.prepararContadores(n);
+        for (size_t i = 0; i < n; ++i) enjambre.evaluacionesLuciernaga[i] = static_cast<unsigned long>(lector.u64());
+        if (version >= 2) {
+            for (size_t i = 0; i < n; ++i) enjambre.movimientosAceptados[i] = static_cast<unsigned long>(lector.u64());
+            for (size_t i = 0; i < n; ++i) enjambre.movimientosRevertidos[i] = static_cast<unsigned long>(lector.u64());
+        }
+        enjambre.trayectorias.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            TrayectoriaEvaluacion& destino = enjambre.trayectorias[i];
+            destino.redimensionar(meses);
+            lector.reales(destino.aguaInicioMes.data(), trayectoria);
+            lector.reales(destino.conductividadInicioMes.data(), trayectoria);
+            lector.reales(destino.cosechaAntesMes.data(), trayectoria);
+        }
+        if (contiguo) enjambre.activarAlmacenamientoContiguo();
+        return punto;
+    }
+
+    // Solo las soluciones de un punto de control, sin restaurar ningun enjambre: la mejor luciernaga
+    // seguida de la poblacion de mayor a menor valor objetivo. No exige que la instancia sea la
+    // misma, solo la forma (cultivos x meses); sirve para arrancar en caliente tras un cambio.
+    static vector<Luciernaga> leerSoluciones(LectorBinario& lector, int numeroCultivos, int meses) {
+        if (lector.u64() != MAGICO) throw runtime_error("no es un punto de control");
+        uint32_t version = lector.u32();
+        if (version < 1 || version > VERSION) throw runtime_error("version " + to_string(version) + " no soportada");
+        lector.u64();  // Huella de la instancia
+        if (lector.i32() != numeroCultivos || lector.i32() != meses) {
+            throw runtime_error("se guardo para otro numero de cultivos o de meses");
+        }
+        lector.u32();  // Nivel SIMD
+        lector.i32();  // numLuciernagas, alfa, beta0, gamma, semilla
+        for (int k = 0; k < 3; ++k) lector.real();
+        lector.u64();
+        for (int k = 0; k < 3; ++k) lector.u32();  // Estrategia y modos
+        lector.i32();
+        lector.real();
+        lector.u32();  // almacenamientoContiguo, sincrono y repararFactibilidad
+        lector.u32();
+        if (version >= 2) lector.u32();
+        lector.i32();  // Iteracion y generador
+        for (int k = 0; k < 4; ++k) lector.u64();
+
+        vector<Luciernaga> soluciones(1, Luciernaga(0));
+        lector.luciernaga(soluciones[0]);
+        size_t n = lector.u32();
+        size_t dimension = lector.u32();
+        size_t esperada = static_cast<size_t>(numeroCultivos) * meses;
+        if (dimension != esperada || soluciones[0].valores.size() != esperada) throw runtime_error("dimension incorrecta");
+        if (lector.restantes() / (8 * (1 + dimension)) < n) throw runtime_error("datos binarios truncados");
+
+        vector<double> objetivos(n);
+        lector.reales(objetivos.data(), n);
+        vector<Luciernaga> poblacion(n, Luciernaga(static_cast<int>(dimension)));
+        for (size_t i = 0; i < n; ++i) {
+            lector.reales(poblacion[i].valores.data(), dimension);
+            poblacion[i].valorObjetivo = objetivos[i];
+        }
+        stable_sort(poblacion.begin(), poblacion.end(),
+                    [](const Luciernaga& a, const Luciernaga& b) { return a.valorObjetivo > b.valorObjetivo; });
+        soluciones.insert(soluciones.end(), poblacion.begin(), poblacion.end());
+        return soluciones;
+    }
+
+   private:
+    // Lee un u32 que tiene que ser menor que 'limite' (enumerados y booleanos)
+    static uint32_t leerEnumerado(LectorBinario& lector, uint32_t limite, const char* campo) {
+        uint32_t valor = lector.u32();
+        if (valor >= limite) throw runtime_error(string(campo) + " fuera de rango: " + to_string(valor));
+        return valor;
+    }
+
+    static double leerReal(LectorBinario& lector, const char* campo) {
+        double valor = lector.real();
+        if (!std::isfinite(valor)) throw runtime_error(string(campo) + " no es un numero finito");
+        return valor;
+    }
+
+    static void escribirAtomicamente(const string& ruta, const vector<uint8_t>& datos) {
+        string temporal = ruta + ".tmp";
+        FILE* archivo = fopen(temporal.c_str(), "wb");
+        if (!archivo) throw runtime_error("No se puede escribir '" + temporal + "'");
+        bool correcto = fwrite(datos.data(), 1, datos.size(), archivo) == datos.size() && fflush(archivo) == 0;
+#ifdef ALGORITMOFA_ARCHIVOS_POSIX
+        // Que los datos esten en disco antes de que el renombrado los haga visibles
+        correcto = correcto && fsync(fileno(archivo)) == 0;
+#endif
+        correcto = fclose(archivo) == 0 && correcto;
+        if (!correcto || rename(temporal.c_str(), ruta.c_str()) != 0) {
+            remove(temporal.c_str());
+            throw runtime_error("Error al escribir el punto de control '" + ruta + "'");
+        }
+    }
+};
+
+#endif /* PUNTOCONTROL_H */
@@ -0,0 +1,39 @@
+#ifndef REGISTRODESHACER_H
+#define REGISTRODESHACER_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Celdas que ha cambiado un movimiento, con su valor anterior, para deshacerlo sin guardar una
+// copia de toda la posicion. Un movimiento aleatorio cambia pocas celdas (las del periodo de
+// crecimiento del cultivo elegido en cada mes), asi que el registro es mucho menor que la
+// posicion en los problemas grandes. La misma celda puede aparecer varias veces: se deshace en
+// orden inverso y queda el valor mas antiguo.
+class RegistroDeshacer {
+   public:
+    void limpiar() { cambios.clear(); }
+
+    // Reserva sitio para 'cuantos' cambios; devuelve true si ha tenido que pedir memoria
+    bool reservar(size_t cuantos) {
+        if (cambios.capacity() >= cuantos) return false;
+        cambios.reserve(cuantos);
+        return true;
+    }
+
+    void anotar(size_t indice, double anterior) { cambios.push_back(make_pair(indice, anterior)); }
+
+    // Devuelve 'valores' al estado del ultimo limpiar()
+    void deshacer(double* valores) const {
+        for (size_t k = cambios.size(); k > 0; --k) valores[cambios[k - 1].first] = cambios[k - 1].second;
+    }
+
+    size_t tamano() const { return cambios.size(); }
+
+   private:
+    vector<pair<size_t, double> > cambios;
+};
+
+#endif /* REGISTRODESHACER_H */
@@ -0,0 +1,160 @@
+#ifndef REPARACIONFACTIBILIDAD_H
+#define REPARACIONFACTIBILIDAD_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+#include "ModeloProblema.h"
+#include "RegistroDeshacer.h"
+
+// Devuelve una posicion al conjunto factible. Una posicion es factible si se puede escribir como
+// plantaciones: el area que un cultivo empieza en un mes en el que es valido y que ocupa sus
+// mesesCultivo meses seguidos (o hasta el final del horizonte), sin que ningun mes sume mas de 1.
+//
+// La reparacion recorre los meses en orden. En cada mes el area que viene de plantaciones
+// anteriores (el arrastre) es fija; lo que la posicion pide por encima de ella es la plantacion
+// nueva del mes, que se anula si el cultivo no puede empezar ese mes, y el vector de plantaciones
+// nuevas se proyecta (distancia euclidea minima) sobre {p >= 0, suma p <= 1 - arrastre total}.
+// Las plantaciones de cada mes se guardan para saber cuales terminan despues, asi que el coste es
+// lineal en cultivos x meses (la proyeccion tiene coste lineal esperado). Una posicion factible
+// no cambia. Cada objeto tiene memoria propia: uno por hilo.
+class ReparacionFactibilidad {
+   public:
+    // Por debajo de esto una diferencia se considera redondeo y no una infraccion
+    static double tolerancia() { return 1e-12; }
+
+    // Devuelve true si ha tenido que pedir memoria
+    bool preparar(int numeroCultivos, int meses) {
+        size_t dimension = static_cast<size_t>(numeroCultivos) * meses;
+        size_t cultivos = static_cast<size_t>(numeroCultivos);
+        bool reserva = false;
+        if (plantaciones.size() < dimension) {
+            plantaciones.resize(dimension);
+            reserva = true;
+        }
+        if (deseadas.size() < cultivos) {
+            arrastres.resize(cultivos);
+            deseadas.resize(cultivos);
+            nuevas.resize(cultivos);
+            activos.resize(cultivos);
+            pendientes.resize(cultivos);
+            reserva = true;
+        }
+        return reserva;
+    }
+
+    // Repara 'valores' (numeroCultivos x meses, por meses) en el sitio, anotando en 'registro' las
+    // celdas cambiadas si se da. Devuelve el primer mes cambiado, o meses si ya era factible.
+    int reparar(double* valores, const ModeloProblema& modelo, RegistroDeshacer* registro = nullptr) {
+        int numeroCultivos = modelo.numeroCultivos;
+        int meses = modelo.meses;
+        preparar(numeroCultivos, meses);
+        int primerMesCambiado = meses;
+        for (int mes = 0; mes < meses; ++mes) {
+            double* areas = valores + static_cast<size_t>(numeroCultivos) * mes;
+            double* plantadas = plantaciones.data() + static_cast<size_t>(numeroCultivos) * mes;
+            double arrastreTotal = 0.0;
+            double sumaNuevas = 0.0;
+            for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+                double arrastre = arrastreCultivo(valores, cultivo, mes, modelo);
+                double deseada = areas[cultivo] - arrastre;
+                double nueva = max(0.0, deseada);
+                if (nueva > tolerancia() && !modelo.esValido(cultivo, mes)) nueva = 0.0;
+                arrastres[cultivo] = arrastre;
+                deseadas[cultivo] = deseada;
+                nuevas[cultivo] = nueva;
+                arrastreTotal += arrastre;
+                sumaNuevas += nueva;
+            }
+
+            double capacidad = max(0.0, 1.0 - arrastreTotal);
+            if (sumaNuevas > capacidad + tolerancia()) proyectarSimplex(nuevas.data(), numeroCultivos, capacidad);
+
+            for (int cultivo = 0; cultivo < numeroCultivos; ++cultivo) {
+                plantadas[cultivo] = nuevas[cultivo];
+                // Si la plantacion que se queda es la que pedia la posicion, el area conserva sus bits
+                double deseada = deseadas[cultivo];
+                if (nuevas[cultivo] == max(0.0, deseada) && deseada >= -tolerancia()) continue;
+                double area = min(1.0, arrastres[cultivo] + nuevas[cultivo]);
+                if (area == areas[cultivo]) continue;
+                if (registro) registro->anotar(&areas[cultivo] - valores, areas[cultivo]);
+                areas[cultivo] = area;
+                primerMesCambiado = min(primerMesCambiado, mes);
+            }
+        }
+        return primerMesCambiado;
+    }
+
+    // Proyeccion euclidea de y (n valores >= 0, suma > a) sobre {x >= 0, suma x = a}, en el sitio.
+    // Calcula el umbral tau con el algoritmo de Condat (2016), de coste lineal esperado, y deja
+    // y[k] = max(0, y[k] - tau).
+    void proyectarSimplex(double* y, int n, double a) {
+        if (a <= 0) {
+            fill(y, y + n, 0.0);
+            return;
+        }
+        double* v = activos.data();
+        double* vt = pendientes.data();
+        size_t nv = 0;
+        size_t nvt = 0;
+        v[nv++] = y[0];
+        double rho = y[0] - a;
+        for (int k = 1; k < n; ++k) {
+            double yk = y[k];
+            if (yk <= rho) continue;
+            rho += (yk - rho) / (nv + 1);
+            if (rho > yk - a) {
+                v[nv++] = yk;
+            } else {
+                for (size_t i = 0; i < nv; ++i) vt[nvt++] = v[i];
+                nv = 0;
+                v[nv++] = yk;
+                rho = yk - a;
+            }
+        }
+        for (size_t i = 0; i < nvt; ++i) {
+            if (vt[i] > rho) {
+                v[nv++] = vt[i];
+                rho += (vt[i] - rho) / nv;
+            }
+        }
+        bool cambio = true;
+        while (cambio && nv > 1) {
+            cambio = false;
+            for (size_t i = 0; i < nv && nv > 1;) {
+                if (v[i] > rho) {
+                    ++i;
+                    continue;
+                }
+                double eliminado = v[i];
+                v[i] = v[--nv];
+                rho += (rho - eliminado) / nv;
+                cambio = true;
+            }
+        }
+        for (int k = 0; k < n; ++k) y[k] = max(0.0, y[k] - rho);
+    }
+
+   private:
+    vector<double> plantaciones;  // Plantacion nueva de cada cultivo y mes, tras reparar
+    vector<double> arrastres;     // Area de cada cultivo que viene de meses anteriores, en el mes en curso
+    vector<double> deseadas;      // Plantacion nueva que pedia la posicion en el mes en curso
+    vector<double> nuevas;        // Plantacion nueva que se queda
+    vector<double> activos;       // Memoria de proyectarSimplex
+    vector<double> pendientes;
+
+    // Area del cultivo en el mes que viene de plantaciones de meses anteriores que siguen creciendo
+    double arrastreCultivo(const double* valores, int cultivo, int mes, const ModeloProblema& modelo) const {
+        if (mes == 0) return 0.0;
+        int numeroCultivos = modelo.numeroCultivos;
+        double arrastre = valores[cultivo + static_cast<size_t>(numeroCultivos) * (mes - 1)];
+        int inicioTerminada = mes - modelo.mesesCultivo[cultivo];
+        if (inicioTerminada >= 0) arrastre -= plantaciones[cultivo + static_cast<size_t>(numeroCultivos) * inicioTerminada];
+        return max(0.0, arrastre);
+    }
+};
+
+#endif /* REPARACIONFACTIBILIDAD_H */
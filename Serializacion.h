@@ -0,0 +1,135 @@
+#ifndef SERIALIZACION_H
+#define SERIALIZACION_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "Luciernaga.h"
+
+// Codificacion binaria compacta, independiente del orden de bytes de la maquina: los enteros y
+// los double (por su patron de bits IEEE 754) se guardan en little-endian. Una Luciernaga ocupa
+// 4 + 8 + 8 * dimension bytes: la dimension (uint32), el valor objetivo y los valores.
+class EscritorBinario {
+   public:
+    vector<uint8_t>& datos;
+
+    explicit EscritorBinario(vector<uint8_t>& datos) : datos(datos) {}
+
+    void u32(uint32_t valor) {
+        for (int b = 0; b < 4; ++b) datos.push_back(static_cast<uint8_t>(valor >> (8 * b)));
+    }
+
+    void u64(uint64_t valor) {
+        for (int b = 0; b < 8; ++b) datos.push_back(static_cast<uint8_t>(valor >> (8 * b)));
+    }
+
+    void i32(int32_t valor) { u32(static_cast<uint32_t>(valor)); }
+
+    void real(double valor) {
+        uint64_t bits;
+        memcpy(&bits, &valor, sizeof(bits));
+        u64(bits);
+    }
+
+    void reales(const double* valores, size_t n) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        // En maquinas little-endian el formato coincide con la memoria: copia directa
+        size_t inicio = datos.size();
+        datos.resize(inicio + 8 * n);
+        if (n > 0) memcpy(&datos[inicio], valores, 8 * n);
+#else
+        for (size_t k = 0; k < n; ++k) real(valores[k]);
+#endif
+    }
+
+    void texto(const string& valor) {
+        u32(static_cast<uint32_t>(valor.size()));
+        datos.insert(datos.end(), valor.begin(), valor.end());
+    }
+
+    void luciernaga(const Luciernaga& l) {
+        u32(static_cast<uint32_t>(l.valores.size()));
+        real(l.valorObjetivo);
+        reales(l.valores.data(), l.valores.size());
+    }
+
+    static size_t tamanoLuciernaga(size_t dimension) { return 4 + 8 + 8 * dimension; }
+};
+
+// Lectura de lo escrito con EscritorBinario. Si los datos se acaban antes de tiempo lanza
+// runtime_error en lugar de leer fuera del buffer.
+class LectorBinario {
+   public:
+    LectorBinario(const uint8_t* datos, size_t tamano) : actual(datos), fin(datos + tamano) {}
+
+    explicit LectorBinario(const vector<uint8_t>& datos) : actual(datos.data()), fin(datos.data() + datos.size()) {}
+
+    uint32_t u32() {
+        exigir(4);
+        uint32_t valor = 0;
+        for (int b = 0; b < 4; ++b) valor |= static_cast<uint32_t>(actual[b]) << (8 * b);
+        actual += 4;
+        return valor;
+    }
+
+    uint64_t u64() {
+        exigir(8);
+        uint64_t valor = 0;
+        for (int b = 0; b < 8; ++b) valor |= static_cast<uint64_t>(actual[b]) << (8 * b);
+        actual += 8;
+        return valor;
+    }
+
+    int32_t i32() { return static_cast<int32_t>(u32()); }
+
+    double real() {
+        uint64_t bits = u64();
+        double valor;
+        memcpy(&valor, &bits, sizeof(valor));
+        return valor;
+    }
+
+    void reales(double* valores, size_t n) {
+        exigir(8 * n);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (n > 0) memcpy(valores, actual, 8 * n);
+        actual += 8 * n;
+#else
+        for (size_t k = 0; k < n; ++k) valores[k] = real();
+#endif
+    }
+
+    string texto() {
+        uint32_t longitud = u32();
+        exigir(longitud);
+        string valor(reinterpret_cast<const char*>(actual), longitud);
+        actual += longitud;
+        return valor;
+    }
+
+    // Lee una luciernaga en 'l', reutilizando su memoria si ya tiene la dimension correcta
+    void luciernaga(Luciernaga& l) {
+        uint32_t dimension = u32();
+        exigir(8 + 8 * static_cast<size_t>(dimension));
+        l.valorObjetivo = real();
+        l.valores.resize(dimension);
+        reales(l.valores.data(), dimension);
+    }
+
+    size_t restantes() const { return static_cast<size_t>(fin - actual); }
+
+   private:
+    const uint8_t* actual;
+    const uint8_t* fin;
+
+    void exigir(size_t bytes) const {
+        if (restantes() < bytes) throw runtime_error("Datos binarios truncados");
+    }
+};
+
+#endif /* SERIALIZACION_H */
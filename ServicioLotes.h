@@ -0,0 +1,327 @@
+#ifndef SERVICIOLOTES_H
+#define SERVICIOLOTES_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include "Aleatorio.h"
+#include "CriteriosParada.h"
+#include "Enjambre.h"
+#include "Instancia.h"
+#include "Luciernaga.h"
+#include "PoolHilos.h"
+
+// Parametros comunes a todos los problemas de un lote
+struct ConfiguracionLotes {
+    int hilos = 1;                    // Problemas que se resuelven a la vez
+    uint64_t semilla = 0;             // Semilla del lote; cada problema deriva la suya de su posicion
+    int luciernagas = 100;
+    bool sincrono = false;
+    bool combinada = false;
+    bool contiguo = false;
+    bool inicializacionRechazo = false;
+    int vecinos = 0;
+    double umbralAtractivo = 0.0;
+    bool repararFactibilidad = false;
+    CriteriosParada criterios;        // Se copian para cada problema; el reloj empieza con el problema
+    size_t pendientesMaximos = 64;    // Problemas leidos que pueden esperar en la cola
+};
+
+// Modo de servicio por lotes: lee una secuencia de instancias, las resuelve a la vez en un grupo
+// de hilos y escribe cada resultado en cuanto termina, sin lanzar un proceso por instancia.
+//
+// Entrada: instancias en el formato de Instancia separadas por lineas que empiezan por '---'; lo
+// que sigue al separador en esa linea es el nombre de la instancia siguiente. Los bloques vacios
+// se ignoran:
+//
+//   --- parcela norte, secano
+//   cultivos 5
+//   ...
+//   --- parcela sur
+//   cultivos 12
+//   ...
+//
+// Salida: una linea JSON por instancia, en el orden en que terminan:
+//   {"trabajo":0,"nombre":"...","cultivos":5,"meses":8,"objetivo":...,"evaluaciones":...,
+//    "iteraciones":...,"parada":"...","segundos":...,"areas":[...]}
+// 'trabajo' es la posicion de la instancia en la entrada (desde 0) y 'areas' la mejor solucion
+// (cultivo + cultivos * mes). Una instancia que no se puede leer da {"trabajo":k,"error":"..."}.
+//
+// Planificacion: el hilo que lee deja cada instancia en una cola de prioridad ordenada por su
+// coste estimado (cultivos * meses * luciernagas) y cada hilo de trabajo saca siempre la mayor
+// de las pendientes, de modo que los problemas grandes empiezan pronto y los pequenos rellenan el
+// final. La cola admite pendientesMaximos problemas; si se llena, la lectura espera. Cada hilo
+// conserva su Enjambre entre problemas (Enjambre::reiniciar), asi que los espacios de trabajo y
+// las trayectorias solo crecen cuando llega un problema mayor que los anteriores. Como la semilla
+// de cada problema solo depende de la semilla del lote y de su posicion, el resultado de cada
+// problema no depende del numero de hilos ni del orden en que se resuelvan.
+class ServicioLotes {
+   public:
+    explicit ServicioLotes(const ConfiguracionLotes& configuracion, FILE* salida = stdout)
+        : configuracion(configuracion), salida(salida) {}
+
+    ServicioLotes(const ServicioLotes&) = delete;
+    ServicioLotes& operator=(const ServicioLotes&) = delete;
+
+    // Lee 'entrada' hasta el final, resuelve todas sus instancias y devuelve cuantas fallaron
+    int ejecutar(istream& entrada) {
+        fallidos = 0;
+        leidoTodo = false;
+        vector<thread> trabajadores;
+        for (int h = 0; h < max(1, configuracion.hilos); ++h) trabajadores.emplace_back(&ServicioLotes::trabajar, this);
+
+        string linea, texto, nombre, siguienteNombre;
+        int indice = 0;
+        bool fin = false;
+        while (!fin) {
+            fin = !getline(entrada, linea);
+            if (!fin && linea.compare(0, 3, "---") != 0) {
+                texto += linea;
+                texto += '\n';
+                continue;
+            }
+            if (!fin) siguienteNombre = recortar(linea.substr(3));
+            if (!esBlanco(texto)) encolar(indice++, nombre, texto);
+            texto.clear();
+            nombre = siguienteNombre;
+        }
+
+        {
+            lock_guard<mutex> bloqueo(cerrojo);
+            leidoTodo = true;
+        }
+        hayTrabajo.notify_all();
+        for (size_t h = 0; h < trabajadores.size(); ++h) trabajadores[h].join();
+        return fallidos;
+    }
+
+    // Semilla del problema 'indice' del lote
+    static uint64_t semillaTrabajo(uint64_t semilla, int indice) {
+        GeneradorAleatorio generador(semilla, FLUJO_LOTES + static_cast<uint64_t>(indice));
+        return generador();
+    }
+
+   private:
+    struct Trabajo {
+        int indice = 0;
+        string nombre;
+        Instancia instancia;
+        unsigned long long coste = 0;
+    };
+
+    // Orden del monticulo: en la cima el de mayor coste y, a igual coste, el primero en leerse
+    static bool menosPrioritario(const Trabajo& a, const Trabajo& b) {
+        if (a.coste != b.coste) return a.coste < b.coste;
+        return a.indice > b.indice;
+    }
+
+    static const uint64_t FLUJO_LOTES = 5ULL << 60;
+
+    ConfiguracionLotes configuracion;
+    FILE* salida;
+    mutex cerrojo;  // Protege la cola, leidoTodo y fallidos
+    condition_variable hayTrabajo;
+    condition_variable hayHueco;
+    vector<Trabajo> pendientes;  // Monticulo segun menosPrioritario
+    bool leidoTodo = false;
+    int fallidos = 0;
+    mutex cerrojoSalida;
+
+    void encolar(int indice, const string& nombre, const string& texto) {
+        Trabajo trabajo;
+        trabajo.indice = indice;
+        trabajo.nombre = nombre;
+        try {
+            istringstream entrada(texto);
+            trabajo.instancia = Instancia::leer(entrada);
+        } catch (const runtime_error& e) {
+            escribirError(indice, nombre, e.what());
+            return;
+        }
+        trabajo.coste = static_cast<unsigned long long>(trabajo.instancia.dimension()) * configuracion.luciernagas;
+
+        unique_lock<mutex> bloqueo(cerrojo);
+        hayHueco.wait(bloqueo, [this] { return pendientes.size() < max<size_t>(1, configuracion.pendientesMaximos); });
+        pendientes.push_back(move(trabajo));
+        push_heap(pendientes.begin(), pendientes.end(), menosPrioritario);
+        bloqueo.unlock();
+        hayTrabajo.notify_one();
+    }
+
+    bool sacar(Trabajo& trabajo) {
+        unique_lock<mutex> bloqueo(cerrojo);
+        hayTrabajo.wait(bloqueo, [this] { return !pendientes.empty() || leidoTodo; });
+        if (pendientes.empty()) return false;
+        pop_heap(pendientes.begin(), pendientes.end(), menosPrioritario);
+        trabajo = move(pendientes.back());
+        pendientes.pop_back();
+        bloqueo.unlock();
+        hayHueco.notify_one();
+        return true;
+    }
+
+    // Bucle de cada hilo de trabajo. El enjambre, el pool de un hilo y las luciernagas auxiliares
+    // se reutilizan de un problema a otro.
+    void trabajar() {
+        unique_ptr<Enjambre> enjambre;
+        PoolHilos pool(1);
+        Luciernaga mejorLuciernaga(0);
+        Luciernaga centroide(0);
+        Trabajo trabajo;
+        while (sacar(trabajo)) {
+            try {
+                resolver(trabajo, enjambre, pool, mejorLuciernaga, centroide);
+            } catch (const exception& e) {
+                escribirError(trabajo.indice, trabajo.nombre, e.what());
+            }
+        }
+    }
+
+    void resolver(Trabajo& trabajo, unique_ptr<Enjambre>& enjambre, PoolHilos& pool, Luciernaga& mejorLuciernaga,
+                  Luciernaga& centroide) {
+        typedef chrono::steady_clock Reloj;
+        Reloj::time_point inicio = Reloj::now();
+        int numeroCultivos = trabajo.instancia.numeroCultivos;
+        int meses = trabajo.instancia.meses;
+        Cultivacion& cultivacion = trabajo.instancia.cultivacion;
+        uint64_t semilla = semillaTrabajo(configuracion.semilla, trabajo.indice);
+
+        if (!enjambre)
+            enjambre.reset(new Enjambre(configuracion.luciernagas, trabajo.instancia.dimension(), semilla));
+        else
+            enjambre->reiniciar(semilla);
+        if (configuracion.inicializacionRechazo) enjambre->estrategiaInicializacion = INICIALIZACION_RECHAZO;
+        if (configuracion.vecinos > 0) {
+            enjambre->modoAtraccion = ATRACCION_VECINOS;
+            enjambre->vecinosAtraccion = configuracion.vecinos;
+        }
+        enjambre->umbralAtractivo = configuracion.umbralAtractivo;
+        enjambre->repararFactibilidad = configuracion.repararFactibilidad;
+        if (configuracion.combinada) enjambre->modoActualizacion = ACTUALIZACION_COMBINADA;
+
+        CriteriosParada criterios = configuracion.criterios;
+        criterios.reiniciarReloj();
+        bool paralelo = configuracion.sincrono || configuracion.combinada;
+        if (paralelo) {
+            enjambre->inicializarLuciernagas(numeroCultivos, meses, cultivacion, pool);
+            enjambre->inicializarValoresObjetivo(numeroCultivos, meses, cultivacion, pool);
+        } else {
+            enjambre->inicializarLuciernagas(numeroCultivos, meses, cultivacion);
+            enjambre->inicializarValoresObjetivo(numeroCultivos, meses, cultivacion);
+        }
+        if (configuracion.contiguo) enjambre->activarAlmacenamientoContiguo();
+
+        enjambre->copiarLuciernaga(enjambre->indiceMejorLuciernaga(), mejorLuciernaga);
+        criterios.iniciar(0, mejorLuciernaga.valorObjetivo);
+        MotivoParada motivo = criterios.iteracionesMaximas > 0 ? PARADA_NINGUNA : PARADA_ITERACIONES;
+        int iter = 0;
+        for (; motivo == PARADA_NINGUNA; ++iter) {
+            if (configuracion.combinada)
+                enjambre->iterarCombinado(numeroCultivos, meses, cultivacion, pool, iter);
+            else if (configuracion.sincrono)
+                enjambre->iterarSincrono(numeroCultivos, meses, cultivacion, pool, iter);
+            else
+                enjambre->iterarSecuencial(numeroCultivos, meses, cultivacion);
+
+            size_t indiceMejor = enjambre->indiceMejorLuciernaga();
+            if (enjambre->valoresObjetivo[indiceMejor] > mejorLuciernaga.valorObjetivo) {
+                enjambre->copiarLuciernaga(indiceMejor, mejorLuciernaga);
+            }
+            motivo = criterios.comprobar(iter + 1, mejorLuciernaga.valorObjetivo, enjambre->evaluaciones(),
+                                         [&]() { return enjambre->calcularDiversidad(centroide); });
+        }
+
+        double segundos = chrono::duration<double>(Reloj::now() - inicio).count();
+        escribirResultado(trabajo, mejorLuciernaga, enjambre->evaluaciones(), iter, motivo, segundos);
+    }
+
+    void escribirResultado(const Trabajo& trabajo, const Luciernaga& mejor, unsigned long long evaluaciones, int iteraciones,
+                           MotivoParada motivo, double segundos) {
+        string linea = "{\"trabajo\":" + to_string(trabajo.indice) + ",\"nombre\":" + textoJson(trabajo.nombre) +
+                       ",\"cultivos\":" + to_string(trabajo.instancia.numeroCultivos) +
+                       ",\"meses\":" + to_string(trabajo.instancia.meses) + ",\"objetivo\":" + real(mejor.valorObjetivo) +
+                       ",\"evaluaciones\":" + to_string(evaluaciones) + ",\"iteraciones\":" + to_string(iteraciones) +
+                       ",\"parada\":" + textoJson(CriteriosParada::describir(motivo)) + ",\"segundos\":" + real(segundos) +
+                       ",\"areas\":[";
+        for (size_t k = 0; k < mejor.valores.size(); ++k) {
+            if (k > 0) linea += ',';
+            linea += real(mejor.valores[k]);
+        }
+        linea += "]}\n";
+        escribirLinea(linea);
+    }
+
+    void escribirError(int indice, const string& nombre, const string& mensaje) {
+        {
+            lock_guard<mutex> bloqueo(cerrojo);
+            ++fallidos;
+        }
+        escribirLinea("{\"trabajo\":" + to_string(indice) + ",\"nombre\":" + textoJson(nombre) +
+                      ",\"error\":" + textoJson(mensaje) + "}\n");
+    }
+
+    // Cada linea sale entera y al momento, aunque la salida sea una tuberia
+    void escribirLinea(const string& linea) {
+        lock_guard<mutex> bloqueo(cerrojoSalida);
+        fputs(linea.c_str(), salida);
+        fflush(salida);
+    }
+
+    static string real(double valor) {
+        char texto[32];
+        snprintf(texto, sizeof(texto), "%.17g", valor);
+        return texto;
+    }
+
+    static string textoJson(const string& texto) {
+        string resultado = "\"";
+        for (size_t k = 0; k < texto.size(); ++k) {
+            unsigned char c = static_cast<unsigned char>(texto[k]);
+            if (c == '"' || c == '\\') {
+                resultado += '\\';
+                resultado += static_cast<char>(c);
+            } else if (c < 0x20) {
+                char escape[8];
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                resultado += escape;
+            } else {
+                resultado += static_cast<char>(c);
+            }
+        }
+        return resultado + "\"";
+    }
+
+    static string recortar(const string& texto) {
+        size_t inicio = texto.find_first_not_of(" \t\r");
+        if (inicio == string::npos) return string();
+        size_t fin = texto.find_last_not_of(" \t\r");
+        return texto.substr(inicio, fin - inicio + 1);
+    }
+
+    // Sin nada mas que espacios y comentarios
+    static bool esBlanco(const string& texto) {
+        bool comentario = false;
+        for (size_t k = 0; k < texto.size(); ++k) {
+            char c = texto[k];
+            if (c == '\n') comentario = false;
+            else if (c == '#') comentario = true;
+            else if (!comentario && c != ' ' && c != '\t' && c != '\r') return false;
+        }
+        return true;
+    }
+};
+
+#endif /* SERVICIOLOTES_H */
@@ -0,0 +1,145 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include "ColaSpsc.h"
+#include "Enjambre.h"
+#include "Luciernaga.h"
+
+enum FormatoTelemetria {
+    TELEMETRIA_NDJSON,  // Un objeto JSON por linea
+    TELEMETRIA_CSV      // Cabecera y una fila por iteracion
+};
+
+// Lo que se sabe del enjambre al terminar una iteracion
+struct RegistroIteracion {
+    int iteracion = 0;
+    double mejor = 0.0;       // Valor objetivo de la mejor, la media y la peor luciernaga
+    double media = 0.0;
+    double peor = 0.0;
+    double diversidad = 0.0;  // Distancia media de las luciernagas a su centroide
+    unsigned long long aceptados = 0;     // Movimientos aleatorios mantenidos en esta iteracion
+    unsigned long long revertidos = 0;    // Movimientos aleatorios revertidos en esta iteracion
+    unsigned long long evaluaciones = 0;  // Evaluaciones de la funcion objetivo desde el principio
+    double segundosIteracion = 0.0;       // Tiempo de cada fase de la iteracion
+    double segundosMedicion = 0.0;
+    double segundosPuntoControl = 0.0;
+};
+
+// Flujo de telemetria por iteracion hacia un archivo o una tuberia. El bucle de optimizacion solo
+// mide el enjambre y deja el registro en una ColaSpsc; un hilo aparte le da formato y lo escribe.
+// Si el escritor no da abasto, los registros que no caben se descartan en lugar de frenar la
+// optimizacion, y al terminar se avisa de cuantos se perdieron.
+class Telemetria {
+   public:
+    Telemetria(const string& ruta, FormatoTelemetria formato, size_t capacidad = 4096) : formato(formato), cola(capacidad) {
+        archivo = fopen(ruta.c_str(), "w");
+        if (!archivo) throw runtime_error("No se puede escribir la telemetria en '" + ruta + "'");
+        if (formato == TELEMETRIA_CSV) {
+            fputs("iteracion,mejor,media,peor,diversidad,aceptados,revertidos,evaluaciones,"
+                  "segundos_iteracion,segundos_medicion,segundos_punto_control\n",
+                  archivo);
+        }
+        escritor = thread(&Telemetria::escribir, this);
+    }
+
+    ~Telemetria() { terminar(); }
+
+    Telemetria(const Telemetria&) = delete;
+    Telemetria& operator=(const Telemetria&) = delete;
+
+    // Toma los movimientos ya hechos por el enjambre (al reanudar, los del punto de control) como
+    // punto de partida, para que la primera iteracion medida solo cuente los suyos
+    void partirDe(const Enjambre& enjambre) {
+        enjambre.movimientosAleatorios(aceptadosAnteriores, revertidosAnteriores);
+    }
+
+    // Mide el enjambre tras la iteracion 'iteracion' y rellena todo menos los tiempos.
+    // No pide memoria salvo la primera vez (el centroide).
+    void medir(Enjambre& enjambre, int iteracion, RegistroIteracion& registro) {
+        size_t n = enjambre.valoresObjetivo.size();
+        registro.iteracion = iteracion;
+        registro.evaluaciones = enjambre.evaluaciones();
+        unsigned long long aceptados, revertidos;
+        enjambre.movimientosAleatorios(aceptados, revertidos);
+        registro.aceptados = aceptados - aceptadosAnteriores;
+        registro.revertidos = revertidos - revertidosAnteriores;
+        aceptadosAnteriores = aceptados;
+        revertidosAnteriores = revertidos;
+        if (n == 0) return;
+
+        const vector<double>& valores = enjambre.valoresObjetivo;
+        registro.mejor = *max_element(valores.begin(), valores.end());
+        registro.peor = *min_element(valores.begin(), valores.end());
+        double suma = 0.0;
+        for (size_t i = 0; i < n; ++i) suma += valores[i];
+        registro.media = suma / n;
+
+        registro.diversidad = enjambre.calcularDiversidad(centroide);
+    }
+
+    // Encola el registro sin esperar; si la cola esta llena se descarta
+    void publicar(const RegistroIteracion& registro) {
+        if (!cola.intentarMeter(registro)) descartados.fetch_add(1, memory_order_relaxed);
+    }
+
+    // Escribe lo pendiente y cierra el archivo
+    void terminar() {
+        if (!archivo) return;
+        parar.store(true, memory_order_release);
+        escritor.join();
+        fclose(archivo);
+        archivo = nullptr;
+        unsigned long perdidos = descartados.load();
+        if (perdidos > 0) fprintf(stderr, "Telemetria: %lu registros descartados por cola llena\n", perdidos);
+    }
+
+   private:
+    FormatoTelemetria formato;
+    FILE* archivo = nullptr;
+    ColaSpsc<RegistroIteracion> cola;
+    thread escritor;
+    atomic<bool> parar{false};
+    atomic<unsigned long> descartados{0};
+    Luciernaga centroide{0};
+    unsigned long long aceptadosAnteriores = 0;
+    unsigned long long revertidosAnteriores = 0;
+
+    // Hilo escritor: vacia la cola y duerme un poco cuando no hay nada
+    void escribir() {
+        RegistroIteracion registro;
+        while (true) {
+            bool terminado = parar.load(memory_order_acquire);
+            bool escrito = false;
+            while (cola.intentarSacar(registro)) {
+                escribirRegistro(registro);
+                escrito = true;
+            }
+            if (escrito) fflush(archivo);
+            if (terminado) break;
+            this_thread::sleep_for(chrono::milliseconds(2));
+        }
+    }
+
+    void escribirRegistro(const RegistroIteracion& r) {
+        const char* plantilla = formato == TELEMETRIA_CSV
+                                    ? "%d,%.17g,%.17g,%.17g,%.17g,%llu,%llu,%llu,%.9f,%.9f,%.9f\n"
+                                    : "{\"iteracion\":%d,\"mejor\":%.17g,\"media\":%.17g,\"peor\":%.17g,\"diversidad\":%.17g,"
+                                      "\"aceptados\":%llu,\"revertidos\":%llu,\"evaluaciones\":%llu,\"segundos_iteracion\":%.9f,"
+                                      "\"segundos_medicion\":%.9f,\"segundos_punto_control\":%.9f}\n";
+        fprintf(archivo, plantilla, r.iteracion, r.mejor, r.media, r.peor, r.diversidad, r.aceptados, r.revertidos,
+                r.evaluaciones, r.segundosIteracion, r.segundosMedicion, r.segundosPuntoControl);
+    }
+};
+
+#endif /* TELEMETRIA_H */
@@ -0,0 +1,31 @@
+#ifndef TRAYECTORIAEVALUACION_H
+#define TRAYECTORIAEVALUACION_H
+
+#include <vector>
+
+using namespace std;
+
+// Estado intermedio de funcionObjetivo al comienzo de cada mes. Guardandolo por luciernaga,
+// un cambio que empieza en el mes m solo obliga a recalcular los meses m, m + 1, ..., meses - 1.
+struct TrayectoriaEvaluacion {
+    vector<double> aguaInicioMes;           // Agua disponible al empezar el mes, con el traslado del mes anterior
+    vector<double> conductividadInicioMes;  // Conductividad electrica al empezar el mes
+    vector<double> cosechaAntesMes;         // Cosecha acumulada de los meses anteriores (la ultima es la total)
+
+    void redimensionar(int meses) {
+        aguaInicioMes.resize(meses + 1, 0.0);
+        conductividadInicioMes.resize(meses + 1, 0.0);
+        cosechaAntesMes.resize(meses + 1, 0.0);
+    }
+
+    // Copia los meses [mesInicio, meses] de otra trayectoria (el prefijo ya coincide)
+    void copiarDesde(const TrayectoriaEvaluacion& otra, int mesInicio) {
+        for (size_t mes = mesInicio; mes < aguaInicioMes.size(); ++mes) {
+            aguaInicioMes[mes] = otra.aguaInicioMes[mes];
+            conductividadInicioMes[mes] = otra.conductividadInicioMes[mes];
+            cosechaAntesMes[mes] = otra.cosechaAntesMes[mes];
+        }
+    }
+};
+
+#endif /* TRAYECTORIAEVALUACION_H */
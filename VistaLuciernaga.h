@@ -0,0 +1,42 @@
+#ifndef VISTALUCIERNAGA_H
+#define VISTALUCIERNAGA_H
+
+#include <algorithm>
+#include <cstddef>
+
+using namespace std;
+
+#include "Luciernaga.h"
+
+// Areas de una luciernaga guardadas fuera de ella (una fila de MatrizPosiciones o el vector de
+// un Luciernaga). Ofrece la parte de la interfaz de vector<double> que usan los operadores.
+struct ValoresVista {
+    double* datos;
+    size_t n;
+
+    double& operator[](size_t i) const { return datos[i]; }
+    size_t size() const { return n; }
+    double* data() const { return datos; }
+    double* begin() const { return datos; }
+    double* end() const { return datos + n; }
+};
+
+// Luciernaga ligera que no es propietaria de su memoria: las areas viven en el almacen del
+// enjambre y el valor objetivo en su arreglo paralelo valoresObjetivo. Copiarla no reserva nada.
+struct VistaLuciernaga {
+    ValoresVista valores;
+    double& valorObjetivo;
+
+    VistaLuciernaga(double* datos, size_t dimension, double& valorObjetivo)
+        : valores{datos, dimension}, valorObjetivo(valorObjetivo) {}
+
+    // Materializa la vista en un Luciernaga independiente
+    Luciernaga copiar() const {
+        Luciernaga luciernaga(static_cast<int>(valores.size()));
+        copy(valores.begin(), valores.end(), luciernaga.valores.begin());
+        luciernaga.valorObjetivo = valorObjetivo;
+        return luciernaga;
+    }
+};
+
+#endif /* VISTALUCIERNAGA_H */
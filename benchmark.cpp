@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include "Enjambre.h"
+#include "EnjambreFijo.h"
+#include "Instancia.h"
+#include "PoolHilos.h"
+
+// Mide el rendimiento de los operadores del algoritmo sobre una rejilla de tamaños de instancia y
+// de enjambre. Escribe una fila CSV por caso con el tiempo por llamada (mediana, minimo, media y
+// desviacion sobre las repeticiones) y las llamadas por segundo, para comparar entre compilaciones.
+//
+//   benchmark [--repeticiones N] [--rapido] [--hilos N] [--simd auto|escalar|avx2|avx512] [--semilla S]
+
+struct OpcionesBenchmark {
+    int repeticiones = 7;                        // --repeticiones N
+    double segundosRepeticion = 0.05;            // Duracion aproximada de cada repeticion
+    bool rapido = false;                         // --rapido: rejilla reducida
+    int hilos = thread::hardware_concurrency();  // --hilos N (iteracion sincrona)
+    string simd = "auto";                        // --simd auto | escalar | avx2 | avx512
+    uint64_t semilla = 12345;                    // --semilla S
+};
+
+OpcionesBenchmark leerOpciones(int argc, char* argv[]) {
+    OpcionesBenchmark opciones;
+    for (int a = 1; a < argc; ++a) {
+        string argumento = argv[a];
+        bool hayValor = a + 1 < argc;
+        if (argumento == "--repeticiones" && hayValor) {
+            opciones.repeticiones = atoi(argv[++a]);
+        } else if (argumento == "--rapido") {
+            opciones.rapido = true;
+            opciones.segundosRepeticion = 0.01;
+        } else if (argumento == "--hilos" && hayValor) {
+            opciones.hilos = atoi(argv[++a]);
+        } else if (argumento == "--simd" && hayValor) {
+            opciones.simd = argv[++a];
+        } else if (argumento == "--semilla" && hayValor) {
+            opciones.semilla = strtoull(argv[++a], nullptr, 10);
+        } else {
+            cerr << "Opcion desconocida: " << argumento << endl;
+        }
+    }
+    if (opciones.repeticiones < 1) opciones.repeticiones = 1;
+    if (opciones.hilos < 1) opciones.hilos = 1;
+    return opciones;
+}
+
+// Evita que el compilador descarte los resultados de las llamadas medidas
+static volatile double sumidero = 0.0;
+
+struct Medicion {
+    long llamadas = 0;               // Llamadas por repeticion
+    vector<double> nsPorLlamada;     // Una entrada por repeticion
+};
+
+// Calibra cuantas llamadas caben en segundosRepeticion y luego repite la medicion.
+// 'lote(n)' debe hacer n llamadas a la operacion medida.
+template <class Lote>
+Medicion medir(const OpcionesBenchmark& opciones, Lote lote) {
+    typedef chrono::steady_clock Reloj;
+    Medicion medicion;
+    long llamadas = 1;
+    while (true) {
+        Reloj::time_point inicio = Reloj::now();
+        lote(llamadas);
+        double segundos = chrono::duration<double>(Reloj::now() - inicio).count();
+        if (segundos >= opciones.segundosRepeticion || llamadas >= (1L << 30)) break;
+        long estimadas = segundos > 0 ? static_cast<long>(llamadas * opciones.segundosRepeticion / segundos * 1.2) : llamadas * 10;
+        llamadas = max(llamadas * 2, min(estimadas, llamadas * 100));
+    }
+    medicion.llamadas = llamadas;
+    for (int r = 0; r < opciones.repeticiones; ++r) {
+        Reloj::time_point inicio = Reloj::now();
+        lote(llamadas);
+        double ns = chrono::duration<double, nano>(Reloj::now() - inicio).count();
+        medicion.nsPorLlamada.push_back(ns / llamadas);
+    }
+    return medicion;
+}
+
+void imprimirCabecera() {
+    cout << "caso,cultivos,meses,dimension,luciernagas,hilos,simd,repeticiones,llamadas_por_repeticion,"
+            "ns_llamada_mediana,ns_llamada_min,ns_llamada_media,ns_llamada_desviacion,llamadas_por_segundo"
+         << endl;
+}
+
+void imprimirFila(const string& caso, const Instancia& instancia, size_t luciernagas, int hilos, const Medicion& medicion) {
+    vector<double> tiempos = medicion.nsPorLlamada;
+    sort(tiempos.begin(), tiempos.end());
+    size_t n = tiempos.size();
+    double mediana = n % 2 ? tiempos[n / 2] : 0.5 * (tiempos[n / 2 - 1] + tiempos[n / 2]);
+    double media = 0.0;
+    for (size_t k = 0; k < n; ++k) media += tiempos[k];
+    media /= n;
+    double varianza = 0.0;
+    for (size_t k = 0; k < n; ++k) varianza += (tiempos[k] - media) * (tiempos[k] - media);
+    double desviacion = n > 1 ? sqrt(varianza / (n - 1)) : 0.0;
+
+    char linea[512];
+    snprintf(linea, sizeof(linea), "%s,%d,%d,%d,%zu,%d,%s,%zu,%ld,%.2f,%.2f,%.2f,%.2f,%.1f",
+             caso.c_str(), instancia.numeroCultivos, instancia.meses, instancia.dimension(), luciernagas, hilos,
+             KernelsSimd::nombreNivel(KernelsSimd::nivelActivo()), n, medicion.llamadas,
+             mediana, tiempos[0], media, desviacion, 1e9 / mediana);
+    cout << linea << endl;
+}
+
+// Los mismos operadores con EnjambreFijo, para las formas que tienen version especializada
+struct MedirFormaFija {
+    const OpcionesBenchmark& opciones;
+    const Instancia& instancia;
+    Enjambre& enjambre;
+
+    MedirFormaFija(const OpcionesBenchmark& opciones, const Instancia& instancia, Enjambre& enjambre)
+        : opciones(opciones), instancia(instancia), enjambre(enjambre) {}
+
+    template <int NumCultivos, int Meses>
+    bool ejecutar() {
+        if (!EnjambreFijo<NumCultivos, Meses>::admite(enjambre)) return false;
+        EnjambreFijo<NumCultivos, Meses> fijo(enjambre);
+        size_t total = fijo.posiciones.size();
+
+        Medicion objetivo = medir(opciones, [&](long llamadas) {
+            double suma = 0.0;
+            for (long k = 0; k < llamadas; ++k) suma += fijo.funcionObjetivo(fijo.posiciones[k % total]);
+            sumidero = sumidero + suma;
+        });
+        imprimirFila("funcionObjetivoFijo", instancia, total, 1, objetivo);
+
+        Medicion secuencial = medir(opciones, [&](long llamadas) {
+            for (long k = 0; k < llamadas; ++k) fijo.iterarSecuencial();
+        });
+        imprimirFila("iterarSecuencialFijo", instancia, total, 1, secuencial);
+        return true;
+    }
+};
+
+// Casos que dependen de la instancia y del tamaño del enjambre
+void medirCasos(const OpcionesBenchmark& opciones, Instancia& instancia, int numLuciernagas, PoolHilos& pool) {
+    int nc = instancia.numeroCultivos;
+    int meses = instancia.meses;
+    Cultivacion& cultivacion = instancia.cultivacion;
+
+    Enjambre enjambre(numLuciernagas, instancia.dimension(), opciones.semilla);
+    enjambre.inicializarLuciernagas(nc, meses, cultivacion);
+    enjambre.inicializarValoresObjetivo(nc, meses, cultivacion);
+    size_t total = enjambre.luciernagas.size();
+    const ModeloProblema& modelo = enjambre.modelo;
+    GeneradorAleatorio generador(opciones.semilla, 1);
+
+    // Operadores sobre una luciernaga: se recorre el enjambre para no medir siempre la misma
+    Medicion objetivo = medir(opciones, [&](long llamadas) {
+        double suma = 0.0;
+        for (long k = 0; k < llamadas; ++k) suma += enjambre.funcionObjetivo(enjambre.luciernagas[k % total], modelo);
+        sumidero = sumidero + suma;
+    });
+    imprimirFila("funcionObjetivo", instancia, total, 1, objetivo);
+
+    Medicion movimiento = medir(opciones, [&](long llamadas) {
+        int suma = 0;
+        for (long k = 0; k < llamadas; ++k) suma += enjambre.movimientoAleatorio(enjambre.luciernagas[k % total], modelo, generador);
+        sumidero = sumidero + suma;
+    });
+    imprimirFila("movimientoAleatorio", instancia, total, 1, movimiento);
+
+    Medicion mover = medir(opciones, [&](long llamadas) {
+        int suma = 0;
+        for (long k = 0; k < llamadas; ++k) {
+            Luciernaga& luciernaga = enjambre.luciernagas[k % total];
+            const Luciernaga& otra = enjambre.luciernagas[(k + 1) % total];
+            double beta = enjambre.calcularAtractivo(enjambre.calcularDistancia(luciernaga, otra));
+            suma += enjambre.moverLuciernaga(luciernaga, otra, beta, modelo, generador);
+        }
+        sumidero = sumidero + suma;
+    });
+    imprimirFila("moverLuciernaga", instancia, total, 1, mover);
+
+    Medicion inicializacion = medir(opciones, [&](long llamadas) {
+        double suma = 0.0;
+        for (long k = 0; k < llamadas; ++k) suma += Luciernaga::inicializar(modelo, enjambre.alfa, generador).valores[0];
+        sumidero = sumidero + suma;
+    });
+    imprimirFila("Luciernaga::inicializar", instancia, total, 1, inicializacion);
+
+    Medicion inicializacionFactible = medir(opciones, [&](long llamadas) {
+        double suma = 0.0;
+        for (long k = 0; k < llamadas; ++k) suma += Luciernaga::inicializarFactible(modelo, generador).valores[0];
+        sumidero = sumidero + suma;
+    });
+    imprimirFila("Luciernaga::inicializarFactible", instancia, total, 1, inicializacionFactible);
+
+    // Iteraciones completas, partiendo de un enjambre recien inicializado
+    enjambre.inicializarValoresObjetivo(nc, meses, cultivacion);
+    Medicion secuencial = medir(opciones, [&](long llamadas) {
+        for (long k = 0; k < llamadas; ++k) enjambre.iterarSecuencial(nc, meses, cultivacion);
+    });
+    imprimirFila("iterarSecuencial", instancia, total, 1, secuencial);
+
+    MedirFormaFija formaFija(opciones, instancia, enjambre);
+    despacharFormaFija(nc, meses, formaFija);
+
+    int iteracion = 0;
+    Medicion sincrona = medir(opciones, [&](long llamadas) {
+        for (long k = 0; k < llamadas; ++k) enjambre.iterarSincrono(nc, meses, cultivacion, pool, iteracion++);
+    });
+    imprimirFila("iterarSincrono", instancia, total, pool.numHilos(), sincrona);
+
+    enjambre.modoAtraccion = ATRACCION_VECINOS;
+    Medicion vecinos = medir(opciones, [&](long llamadas) {
+        for (long k = 0; k < llamadas; ++k) enjambre.iterarSincrono(nc, meses, cultivacion, pool, iteracion++);
+    });
+    imprimirFila("iterarSincronoVecinos" + to_string(enjambre.vecinosAtraccion), instancia, total, pool.numHilos(), vecinos);
+
+    enjambre.modoAtraccion = ATRACCION_TODOS;
+    enjambre.modoActualizacion = ACTUALIZACION_COMBINADA;
+    Medicion combinada = medir(opciones, [&](long llamadas) {
+        for (long k = 0; k < llamadas; ++k) enjambre.iterarCombinado(nc, meses, cultivacion, pool, iteracion++);
+    });
+    imprimirFila("iterarCombinado", instancia, total, pool.numHilos(), combinada);
+}
+
+int main(int argc, char* argv[]) {
+    OpcionesBenchmark opciones = leerOpciones(argc, argv);
+    if (opciones.simd == "escalar")
+        KernelsSimd::fijarNivel(KernelsSimd::ESCALAR);
+    else if (opciones.simd == "avx2")
+        KernelsSimd::fijarNivel(KernelsSimd::AVX2);
+    else if (opciones.simd == "avx512")
+        KernelsSimd::fijarNivel(KernelsSimd::AVX512);
+
+    // Rejilla: el ejemplo de Cultivacion y tres instancias sinteticas mas grandes (20x24 tiene
+    // version especializada, como el ejemplo)
+    vector<Instancia> instancias;
+    instancias.push_back(Instancia());
+    instancias.push_back(Instancia::generar(20, 24, opciones.semilla));
+    instancias.push_back(Instancia::generar(40, 24, opciones.semilla));
+    if (!opciones.rapido) instancias.push_back(Instancia::generar(100, 48, opciones.semilla));
+
+    vector<int> tamanosEnjambre;
+    tamanosEnjambre.push_back(16);
+    tamanosEnjambre.push_back(64);
+    if (!opciones.rapido) tamanosEnjambre.push_back(128);
+
+    PoolHilos pool(opciones.hilos);
+    imprimirCabecera();
+    for (size_t i = 0; i < instancias.size(); ++i) {
+        for (size_t t = 0; t < tamanosEnjambre.size(); ++t) {
+            medirCasos(opciones, instancias[i], tamanosEnjambre[t], pool);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#!/bin/sh
+# Comprobaciones de 'make check' sobre un ejecutable compilado con -DALGORITMOFA_CONTAR_ASIGNACIONES:
+#   - el bucle de iteraciones no pide memoria despues de la primera iteracion, en cada modo;
+#   - reanudar desde un punto de control da exactamente el mismo resultado que no parar;
+#   - el frente de --multiobjetivo no tiene ningun punto dominado por otro.
+# Uso: comprobaciones.sh ejecutable. Termina con 1 si falla alguna.
+
+EJECUTABLE=$1
+if [ ! -x "$EJECUTABLE" ]; then
+    echo "Uso: $0 ejecutable" >&2
+    exit 2
+fi
+TEMPORAL=$(mktemp -d)
+trap 'rm -rf "$TEMPORAL"' EXIT
+FALLOS=0
+
+fallo() {
+    echo "FALLO: $1" >&2
+    FALLOS=$((FALLOS + 1))
+}
+
+# Reservas de memoria tras la primera iteracion
+for MODO in "" "--modo sincrono --hilos 2" "--actualizacion combinada --contiguo --hilos 2" "--vecinos 8" \
+    "--forma-dinamica" "--reparar" "--cache 4096"; do
+    RESERVAS=$("$EJECUTABLE" --semilla 3 --luciernagas 40 --iteraciones 20 $MODO 2>&1 >/dev/null |
+        sed -n 's/^Reservas de memoria despues de la primera iteracion: //p')
+    if [ -z "$RESERVAS" ]; then
+        fallo "sin recuento de reservas con '$MODO' (hay que compilar con -DALGORITMOFA_CONTAR_ASIGNACIONES)"
+    elif [ "$RESERVAS" -ne 0 ]; then
+        fallo "$RESERVAS reservas de memoria despues de la primera iteracion con '$MODO'"
+    fi
+done
+
+# Punto de control: 40 iteraciones seguidas frente a 20, punto de control y reanudar hasta 40
+for MODO in "" "--modo sincrono --hilos 2" "--actualizacion combinada --contiguo --hilos 2" "--vecinos 8 --reparar"; do
+    PARAMETROS="--semilla 5 --luciernagas 30 $MODO"
+    "$EJECUTABLE" $PARAMETROS --iteraciones 40 --punto-control "$TEMPORAL/seguido.pc" >"$TEMPORAL/seguido.txt" 2>/dev/null
+    "$EJECUTABLE" $PARAMETROS --iteraciones 20 --punto-control "$TEMPORAL/mitad.pc" >/dev/null 2>&1
+    "$EJECUTABLE" $PARAMETROS --iteraciones 40 --reanudar "$TEMPORAL/mitad.pc" >"$TEMPORAL/reanudado.txt" 2>/dev/null
+    if ! cmp -s "$TEMPORAL/seguido.txt" "$TEMPORAL/reanudado.txt"; then
+        fallo "reanudar desde el punto de control no reproduce la ejecucion seguida con '$MODO'"
+    fi
+done
+
+# Frente de Pareto: ningun punto domina a otro (cosecha a maximizar, agua y salinidad a minimizar)
+for MODO in "--capacidad-frente 100" "--capacidad-frente 8" "--capacidad-frente 8 --reparar"; do
+    if ! "$EJECUTABLE" --semilla 7 --luciernagas 30 --iteraciones 30 --multiobjetivo $MODO \
+        --guardar-frente "$TEMPORAL/frente.csv" >/dev/null 2>&1; then
+        fallo "--multiobjetivo $MODO no termino bien"
+        continue
+    fi
+    DOMINADOS=$(awk -F, 'NR > 1 { c[n] = $1; a[n] = $2; s[n] = $3; ++n }
+        END {
+            d = 0
+            for (i = 0; i < n; ++i)
+                for (j = 0; j < n; ++j)
+                    if (i != j && c[j] >= c[i] && a[j] <= a[i] && s[j] <= s[i] &&
+                        (c[j] > c[i] || a[j] < a[i] || s[j] < s[i])) { ++d; break }
+            print (n == 0 ? -1 : d)
+        }' "$TEMPORAL/frente.csv")
+    if [ "$DOMINADOS" -ne 0 ]; then
+        fallo "frente de Pareto con '$MODO': $DOMINADOS puntos dominados (-1: frente vacio)"
+    fi
+done
+
+if [ "$FALLOS" -ne 0 ]; then
+    echo "$FALLOS comprobaciones fallidas" >&2
+    exit 1
+fi
+echo "Comprobaciones correctas"
@@ -1,76 +1,709 @@
+#include <chrono>
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
 using namespace std;
 
+#include "ArranqueCaliente.h"
+#include "Archipielago.h"
+#include "ContadorAsignaciones.h"
+#include "CriteriosParada.h"
+#include "Distribuido.h"
 #include "Enjambre.h"
+#include "EnjambreFijo.h"
+#include "EnjambreMultiobjetivo.h"
+#include "Instancia.h"
+#include "Instrumentacion.h"
+#include "PoolHilos.h"
+#include "PuntoControl.h"
+#include "ServicioLotes.h"
+#include "Telemetria.h"
 
-int main() {
-    srand(static_cast<unsigned int>(time(0)));
+// Opciones de ejecucion leidas de la linea de comandos
+struct Opciones {
+    bool sincrono = false;                              // --modo sincrono | secuencial
+    bool contiguo = false;                              // --contiguo: posiciones en una matriz contigua
+    int hilos = thread::hardware_concurrency();         // --hilos N
+    uint64_t semilla = static_cast<uint64_t>(time(0));  // --semilla S
+    string simd = "auto";                               // --simd auto | escalar | avx2 | avx512
+    int luciernagas = 100;                              // --luciernagas N
+    int iteraciones = 100;                              // --iteraciones N
+    string instancia;                                   // --instancia archivo: problema a resolver
+    int cultivosGenerados = 0;                          // --generar CxM: instancia sintetica de C cultivos y M meses
+    int mesesGenerados = 0;
+    string guardarInstancia;                            // --guardar-instancia archivo
+    bool inicializacionRechazo = false;                 // --inicializacion factible | rechazo
+    int vecinos = 0;                                    // --vecinos K: atraccion solo entre las K vecinas mas cercanas
+    double umbralAtractivo = 0.0;                       // --umbral-atractivo B: ignorar parejas con atractivo < B
+    bool reparar = false;                               // --reparar: reparar la factibilidad tras cada movimiento
+    size_t entradasCache = 0;                           // --cache N: cache de evaluaciones de N entradas (0: sin cache)
+    double resolucionCache = 1e-6;                      // --resolucion-cache R: cuantizacion de las posiciones en la cache
+    bool combinada = false;                             // --actualizacion pareja | combinada
+    int islas = 1;                                      // --islas N: modelo de islas con N enjambres
+    int intervaloMigracion = 10;                        // --migracion K: iteraciones entre migraciones
+    int migrantes = 2;                                  // --migrantes M: luciernagas que emigran cada vez
+    bool topologiaAleatoria = false;                    // --topologia anillo | aleatoria
+    bool variarParametros = false;                      // --variar-parametros: gamma distinto en cada isla
+    int distribuido = 0;                                // --distribuido N: N procesos trabajadores, uno por isla
+    string rutaSocket;                                  // --socket ruta: socket Unix del coordinador
+    bool sinLanzar = false;                             // --sin-lanzar: esperar trabajadores lanzados a mano
+    string trabajador;                                  // --trabajador ruta: ejecutar como trabajador
+    int idTrabajador = -1;                              // --id K: identificador pedido por el trabajador
+    string puntoControl;                                // --punto-control archivo: guardar el estado periodicamente
+    int intervaloPuntoControl = 10;                     // --cada K: iteraciones entre puntos de control
+    string reanudar;                                    // --reanudar archivo: continuar desde un punto de control
+    string telemetria;                                  // --telemetria archivo: estadisticas de cada iteracion
+    bool telemetriaCsv = false;                         // --formato-telemetria ndjson | csv
+    int estancamiento = 0;                              // --estancamiento K: parar tras K iteraciones sin mejora
+    double toleranciaEstancamiento = 0.0;               // --tolerancia-estancamiento T: mejora relativa minima
+    double diversidadMinima = 0.0;                      // --diversidad-minima D: parar si el enjambre se concentra
+    double tiempoMaximo = 0.0;                          // --tiempo-maximo S: segundos de ejecucion como mucho
+    unsigned long long evaluacionesMaximas = 0;         // --evaluaciones-maximas N
+    string lote;                                        // --lote archivo | -: resolver una secuencia de instancias
+    string arranque;                                    // --arranque archivo: solucion o punto de control previos
+    double fraccionArranque = 0.5;                      // --fraccion-arranque F: parte del enjambre sembrada con ellos
+    bool reoptimizar = false;                           // --reoptimizar: con --arranque, iteraciones / 5 y parada por estancamiento
+    string guardarSolucion;                             // --guardar-solucion archivo: mejor solucion al terminar
+    bool formaDinamica = false;                         // --forma-dinamica: no usar EnjambreFijo aunque haya version
+    bool multiobjetivo = false;                         // --multiobjetivo: cosecha, agua y salinidad con archivo de Pareto
+    int capacidadFrente = 100;                          // --capacidad-frente N: puntos del frente como mucho
+    string guardarFrente;                               // --guardar-frente archivo: frente de Pareto en CSV
+    bool invalidas = false;                             // Alguna opcion tiene un valor que no se puede usar
+};
 
-    int numLuciernagas = 100;  // Numero de luciernagas
-    int iteraciones = 100;     // Numero de iteraciones
+const int FACTOR_REOPTIMIZACION = 5;   // --reoptimizar divide las iteraciones por este factor
+const int VENTANA_REOPTIMIZACION = 5;  // y, si no hay --estancamiento, para tras estas iteraciones sin mejora
 
-    int meses = 8;                           // Numero de meses
-    int numeroCultivos = 5;                  // Numero de cultivos
-    int dimension = numeroCultivos * meses;  // Dimension total
-
-    Cultivacion cultivacion(meses, numeroCultivos);
-    Enjambre enjambre(numLuciernagas, dimension);
-
-    enjambre.inicializarLuciernagas(numeroCultivos, meses, cultivacion);
-    enjambre.inicializarValoresObjetivo(numeroCultivos, meses, cultivacion);
-
-    Luciernaga mejorLuciernaga = enjambre.encontrarMejorLuciernaga();
-    double mejorValor = mejorLuciernaga.valorObjetivo;
-
-    for (int iter = 0; iter < iteraciones; ++iter) {
-        for (size_t i = 0; i < enjambre.luciernagas.size(); ++i) {
-            for (size_t j = 0; j < enjambre.luciernagas.size(); ++j) {
-                if (i == j) {
-                    // Guardar la posicion actual para movimiento aleatorio
-                    Luciernaga luciernagaOriginal = enjambre.luciernagas[i];
-
-                    enjambre.movimientoAleatorio(enjambre.luciernagas[i],
-                                                 numeroCultivos, meses,
-                                                 cultivacion);
-                    double nuevoValor = enjambre.funcionObjetivo(enjambre.luciernagas[i],
-                                                                 numeroCultivos, meses,
-                                                                 cultivacion);
-                    // Revertir si la nueva posicion es peor
-                    if (nuevoValor < enjambre.valoresObjetivo[i])
-                        enjambre.luciernagas[i] = luciernagaOriginal;
-                    else  // Actualizar el valor objetivo de lo contrario
-                        enjambre.valoresObjetivo[i] = nuevoValor;
-
-                } else {
-                    if (enjambre.valoresObjetivo[j] > enjambre.valoresObjetivo[i]) {
-                        double distancia = enjambre.calcularDistancia(enjambre.luciernagas[i],
-                                                                      enjambre.luciernagas[j]);
-                        double beta = enjambre.calcularAtractivo(distancia);
-
-                        enjambre.moverLuciernaga(enjambre.luciernagas[i], enjambre.luciernagas[j],
-                                                 beta, numeroCultivos, meses, cultivacion);
-                        enjambre.actualizarValorObjetivo(i, numeroCultivos, meses, cultivacion);
-                    }
-                }
+Opciones leerOpciones(int argc, char* argv[]) {
+    Opciones opciones;
+    for (int a = 1; a < argc; ++a) {
+        string argumento = argv[a];
+        bool hayValor = a + 1 < argc;
+        if (argumento == "--modo" && hayValor) {
+            opciones.sincrono = strcmp(argv[++a], "sincrono") == 0;
+        } else if (argumento == "--contiguo") {
+            opciones.contiguo = true;
+        } else if (argumento == "--hilos" && hayValor) {
+            opciones.hilos = atoi(argv[++a]);
+        } else if (argumento == "--simd" && hayValor) {
+            opciones.simd = argv[++a];
+        } else if (argumento == "--semilla" && hayValor) {
+            opciones.semilla = strtoull(argv[++a], nullptr, 10);
+        } else if (argumento == "--luciernagas" && hayValor) {
+            opciones.luciernagas = atoi(argv[++a]);
+        } else if (argumento == "--iteraciones" && hayValor) {
+            opciones.iteraciones = atoi(argv[++a]);
+        } else if (argumento == "--instancia" && hayValor) {
+            opciones.instancia = argv[++a];
+        } else if (argumento == "--generar" && hayValor) {
+            if (sscanf(argv[++a], "%dx%d", &opciones.cultivosGenerados, &opciones.mesesGenerados) != 2 ||
+                opciones.cultivosGenerados < 1 || opciones.mesesGenerados < 1) {
+                cerr << "--generar espera CULTIVOSxMESES, por ejemplo 200x120" << endl;
+                opciones.invalidas = true;
             }
+        } else if (argumento == "--guardar-instancia" && hayValor) {
+            opciones.guardarInstancia = argv[++a];
+        } else if (argumento == "--inicializacion" && hayValor) {
+            opciones.inicializacionRechazo = strcmp(argv[++a], "rechazo") == 0;
+        } else if (argumento == "--vecinos" && hayValor) {
+            opciones.vecinos = atoi(argv[++a]);
+        } else if (argumento == "--umbral-atractivo" && hayValor) {
+            opciones.umbralAtractivo = atof(argv[++a]);
+        } else if (argumento == "--actualizacion" && hayValor) {
+            opciones.combinada = strcmp(argv[++a], "combinada") == 0;
+        } else if (argumento == "--islas" && hayValor) {
+            opciones.islas = atoi(argv[++a]);
+        } else if (argumento == "--migracion" && hayValor) {
+            opciones.intervaloMigracion = atoi(argv[++a]);
+        } else if (argumento == "--migrantes" && hayValor) {
+            opciones.migrantes = atoi(argv[++a]);
+        } else if (argumento == "--topologia" && hayValor) {
+            opciones.topologiaAleatoria = strcmp(argv[++a], "aleatoria") == 0;
+        } else if (argumento == "--variar-parametros") {
+            opciones.variarParametros = true;
+        } else if (argumento == "--distribuido" && hayValor) {
+            opciones.distribuido = atoi(argv[++a]);
+        } else if (argumento == "--socket" && hayValor) {
+            opciones.rutaSocket = argv[++a];
+        } else if (argumento == "--sin-lanzar") {
+            opciones.sinLanzar = true;
+        } else if (argumento == "--trabajador" && hayValor) {
+            opciones.trabajador = argv[++a];
+        } else if (argumento == "--id" && hayValor) {
+            opciones.idTrabajador = atoi(argv[++a]);
+        } else if (argumento == "--punto-control" && hayValor) {
+            opciones.puntoControl = argv[++a];
+        } else if (argumento == "--cada" && hayValor) {
+            opciones.intervaloPuntoControl = atoi(argv[++a]);
+        } else if (argumento == "--reanudar" && hayValor) {
+            opciones.reanudar = argv[++a];
+        } else if (argumento == "--telemetria" && hayValor) {
+            opciones.telemetria = argv[++a];
+        } else if (argumento == "--formato-telemetria" && hayValor) {
+            opciones.telemetriaCsv = strcmp(argv[++a], "csv") == 0;
+        } else if (argumento == "--estancamiento" && hayValor) {
+            opciones.estancamiento = atoi(argv[++a]);
+        } else if (argumento == "--tolerancia-estancamiento" && hayValor) {
+            opciones.toleranciaEstancamiento = atof(argv[++a]);
+        } else if (argumento == "--diversidad-minima" && hayValor) {
+            opciones.diversidadMinima = atof(argv[++a]);
+        } else if (argumento == "--tiempo-maximo" && hayValor) {
+            opciones.tiempoMaximo = atof(argv[++a]);
+        } else if (argumento == "--evaluaciones-maximas" && hayValor) {
+            opciones.evaluacionesMaximas = strtoull(argv[++a], nullptr, 10);
+        } else if (argumento == "--lote" && hayValor) {
+            opciones.lote = argv[++a];
+        } else if (argumento == "--arranque" && hayValor) {
+            opciones.arranque = argv[++a];
+        } else if (argumento == "--fraccion-arranque" && hayValor) {
+            opciones.fraccionArranque = atof(argv[++a]);
+        } else if (argumento == "--reoptimizar") {
+            opciones.reoptimizar = true;
+        } else if (argumento == "--guardar-solucion" && hayValor) {
+            opciones.guardarSolucion = argv[++a];
+        } else if (argumento == "--reparar") {
+            opciones.reparar = true;
+        } else if (argumento == "--cache" && hayValor) {
+            opciones.entradasCache = static_cast<size_t>(strtoull(argv[++a], nullptr, 10));
+        } else if (argumento == "--resolucion-cache" && hayValor) {
+            opciones.resolucionCache = max(0.0, atof(argv[++a]));
+        } else if (argumento == "--forma-dinamica") {
+            opciones.formaDinamica = true;
+        } else if (argumento == "--multiobjetivo") {
+            opciones.multiobjetivo = true;
+        } else if (argumento == "--capacidad-frente" && hayValor) {
+            opciones.capacidadFrente = atoi(argv[++a]);
+        } else if (argumento == "--guardar-frente" && hayValor) {
+            opciones.guardarFrente = argv[++a];
+        } else {
+            cerr << "Opcion desconocida: " << argumento << endl;
         }
-        Luciernaga luciernagaActualMejor = enjambre.encontrarMejorLuciernaga();
-        if (luciernagaActualMejor.valorObjetivo > mejorValor) {
-            mejorLuciernaga = luciernagaActualMejor;
-            mejorValor = luciernagaActualMejor.valorObjetivo;
-        }
     }
+    if (opciones.hilos < 1) opciones.hilos = 1;
+    if (opciones.islas < 1) opciones.islas = 1;
+    if (opciones.luciernagas < 1) opciones.luciernagas = 1;
+    if (opciones.iteraciones < 0) opciones.iteraciones = 0;
+    if (opciones.intervaloPuntoControl < 1) opciones.intervaloPuntoControl = 1;
+    if (opciones.capacidadFrente < 2) opciones.capacidadFrente = 2;
+    opciones.fraccionArranque = max(0.0, min(1.0, opciones.fraccionArranque));
+    // Reoptimizar tras un cambio pequeno: se parte de la solucion anterior y basta con menos
+    // iteraciones; si no se pidio otra cosa, tambien se para en cuanto deja de mejorar
+    if (opciones.reoptimizar && !opciones.arranque.empty()) {
+        opciones.iteraciones = max(1, opciones.iteraciones / FACTOR_REOPTIMIZACION);
+        if (opciones.estancamiento == 0) opciones.estancamiento = VENTANA_REOPTIMIZACION;
+    }
+    return opciones;
+}
+
+CriteriosParada criteriosParada(const Opciones& opciones) {
+    CriteriosParada criterios;
+    criterios.iteracionesMaximas = opciones.iteraciones;
+    criterios.ventanaEstancamiento = opciones.estancamiento;
+    criterios.toleranciaEstancamiento = opciones.toleranciaEstancamiento;
+    criterios.diversidadMinima = opciones.diversidadMinima;
+    criterios.segundosMaximos = opciones.tiempoMaximo;
+    criterios.evaluacionesMaximas = opciones.evaluacionesMaximas;
+    return criterios;
+}
+
+void imprimirParada(MotivoParada motivo, int iteraciones) {
+    cout << "Criterio de parada: " << CriteriosParada::describir(motivo) << " tras " << iteraciones << " iteraciones" << endl;
+}
+
+void imprimirResultado(const Luciernaga& mejorLuciernaga, int numeroCultivos, int meses, const Cultivacion& cultivacion,
+                       unsigned long long evaluaciones) {
     mejorLuciernaga.imprimirDetallesLuciernaga(numeroCultivos, meses,
                                                cultivacion.areaTotalDisponible,
                                                cultivacion.requerimientoAgua,
                                                cultivacion.mesesCultivo,
                                                cultivacion.maxCosechaPorArea);
+    cout << "Evaluaciones de la funcion objetivo: " << evaluaciones << endl;
+    if (Instrumentacion::activo()) Instrumentacion::imprimirResumen(cerr);
+}
+
+// Bucle principal con EnjambreFijo, para las formas que tienen version especializada (ver
+// despacharFormaFija). Da los mismos resultados que el bucle con Enjambre::iterarSecuencial.
+struct IteracionFija {
+    Enjambre& enjambre;
+    CriteriosParada& criterios;
+    Luciernaga& mejorLuciernaga;
+    Luciernaga& centroide;
+    int iteracion;  // Primera iteracion y, al terminar, la siguiente a la ultima hecha
+    unsigned long asignacionesTrasPrimeraIteracion = 0;
+    MotivoParada motivo = PARADA_NINGUNA;
+
+    IteracionFija(Enjambre& enjambre, CriteriosParada& criterios, Luciernaga& mejorLuciernaga, Luciernaga& centroide,
+                  int primeraIteracion)
+        : enjambre(enjambre), criterios(criterios), mejorLuciernaga(mejorLuciernaga), centroide(centroide),
+          iteracion(primeraIteracion) {}
+
+    template <int NumCultivos, int Meses>
+    bool ejecutar() {
+        if (!EnjambreFijo<NumCultivos, Meses>::admite(enjambre)) return false;
+        EnjambreFijo<NumCultivos, Meses> fijo(enjambre);
+        int primeraIteracion = iteracion;
+        for (; motivo == PARADA_NINGUNA; ++iteracion) {
+            fijo.iterarSecuencial();
+            size_t indiceMejor = fijo.indiceMejorLuciernaga();
+            if (fijo.valoresObjetivo[indiceMejor] > mejorLuciernaga.valorObjetivo) {
+                fijo.copiarLuciernaga(indiceMejor, mejorLuciernaga);
+            }
+            motivo = criterios.comprobar(iteracion + 1, mejorLuciernaga.valorObjetivo, fijo.evaluaciones(),
+                                         [&]() { return fijo.calcularDiversidad(centroide); });
+            if (iteracion == primeraIteracion) asignacionesTrasPrimeraIteracion = ContadorAsignaciones::total();
+        }
+        fijo.volcarEn(enjambre);
+        return true;
+    }
+};
+
+// Escribe la mejor solucion en --guardar-solucion, si se pidio; devuelve false si no se pudo
+bool guardarSolucion(const Opciones& opciones, const Luciernaga& mejorLuciernaga, int numeroCultivos, int meses) {
+    if (opciones.guardarSolucion.empty()) return true;
+    try {
+        ArranqueCaliente::guardarSolucion(opciones.guardarSolucion, mejorLuciernaga, numeroCultivos, meses);
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return false;
+    }
+    return true;
+}
+
+// Modelo de islas: cada isla es un enjambre de --luciernagas luciernagas, con las opciones de
+// movimiento del enjambre unico, y las islas se reparten entre los --hilos hilos
+int resolverConIslas(const Opciones& opciones, int numeroCultivos, int meses, Cultivacion& cultivacion) {
+    Archipielago archipielago(opciones.islas, opciones.luciernagas, numeroCultivos * meses, opciones.semilla);
+    archipielago.intervaloMigracion = opciones.intervaloMigracion;
+    archipielago.numMigrantes = opciones.migrantes;
+    archipielago.topologia = opciones.topologiaAleatoria ? MIGRACION_ALEATORIA : MIGRACION_ANILLO;
+    if (opciones.combinada) archipielago.modoActualizacion = ACTUALIZACION_COMBINADA;
+    archipielago.sincrono = opciones.sincrono;
+    if (opciones.inicializacionRechazo) archipielago.estrategiaInicializacion = INICIALIZACION_RECHAZO;
+    archipielago.vecinosAtraccion = opciones.vecinos;
+    archipielago.umbralAtractivo = opciones.umbralAtractivo;
+    archipielago.contiguo = opciones.contiguo;
+    if (opciones.variarParametros) {
+        archipielago.fijarParametros(Archipielago::parametrosEscalonados(opciones.islas, ParametrosIsla()));
+    }
+
+    CriteriosParada criterios = criteriosParada(opciones);
+    PoolHilos pool(opciones.hilos);
+    archipielago.inicializar(numeroCultivos, meses, cultivacion, pool);
+
+    // Los criterios se comprueban entre epocas de migracion; la diversidad es la media de las islas
+    Luciernaga centroide(0);
+    int hechas = 0;
+    int intervalo = max(1, opciones.intervaloMigracion);
+    criterios.iniciar(0, archipielago.mejorLuciernaga.valorObjetivo);
+    MotivoParada motivo = opciones.iteraciones > 0 ? PARADA_NINGUNA : PARADA_ITERACIONES;
+    while (motivo == PARADA_NINGUNA) {
+        int pasos = min(intervalo, opciones.iteraciones - hechas);
+        archipielago.iterar(pasos, numeroCultivos, meses, cultivacion, pool);
+        hechas += pasos;
+        motivo = criterios.comprobar(hechas, archipielago.mejorLuciernaga.valorObjetivo, archipielago.evaluaciones(), [&]() {
+            double suma = 0.0;
+            for (int k = 0; k < archipielago.numIslas; ++k) suma += archipielago.islas[k]->calcularDiversidad(centroide);
+            return suma / archipielago.numIslas;
+        });
+    }
+
+    imprimirParada(motivo, hechas);
+    imprimirResultado(archipielago.mejorLuciernaga, numeroCultivos, meses, cultivacion, archipielago.evaluaciones());
+    return guardarSolucion(opciones, archipielago.mejorLuciernaga, numeroCultivos, meses) ? 0 : 1;
+}
+
+// Modo multiobjetivo: un enjambre de --luciernagas luciernagas que busca el frente de Pareto entre
+// cosecha, agua requerida y salinidad final. Se informa de la solucion de mayor cosecha del frente
+// (la que se guarda con --guardar-solucion) y del frente entero con --guardar-frente.
+int resolverMultiobjetivo(const Opciones& opciones, int numeroCultivos, int meses, Cultivacion& cultivacion) {
+    EnjambreMultiobjetivo multiobjetivo(opciones.luciernagas, numeroCultivos * meses, opciones.semilla, opciones.capacidadFrente);
+    Enjambre& enjambre = multiobjetivo.enjambre;
+    if (opciones.inicializacionRechazo) enjambre.estrategiaInicializacion = INICIALIZACION_RECHAZO;
+    enjambre.umbralAtractivo = opciones.umbralAtractivo;
+    enjambre.repararFactibilidad = opciones.reparar;
+    multiobjetivo.inicializar(numeroCultivos, meses, cultivacion);
+
+    CriteriosParada criterios = criteriosParada(opciones);
+    Luciernaga centroide(0);
+    criterios.iniciar(0, multiobjetivo.mejorCosecha());
+    MotivoParada motivo = opciones.iteraciones > 0 ? PARADA_NINGUNA : PARADA_ITERACIONES;
+    int iter = 0;
+    for (; motivo == PARADA_NINGUNA; ++iter) {
+        multiobjetivo.iterar(numeroCultivos, meses, cultivacion);
+        motivo = criterios.comprobar(iter + 1, multiobjetivo.mejorCosecha(), multiobjetivo.evaluaciones(),
+                                     [&]() { return enjambre.calcularDiversidad(centroide); });
+    }
+
+    const ArchivoPareto& archivo = multiobjetivo.archivo;
+    Luciernaga mejorCosecha(0);
+    mejorCosecha.valores = archivo.solucion(0);
+    mejorCosecha.valorObjetivo = archivo.objetivos(0).cosecha;
+    imprimirParada(motivo, iter);
+    imprimirResultado(mejorCosecha, numeroCultivos, meses, cultivacion, multiobjetivo.evaluaciones());
+
+    cout << "Frente de Pareto: " << archivo.tamano() << " soluciones (" << archivo.descartados()
+         << " descartadas por capacidad)" << endl;
+    cout << setw(14) << "Cosecha" << setw(14) << "Agua" << setw(14) << "Salinidad" << endl;
+    size_t mostrados = min<size_t>(archivo.tamano(), 10);
+    for (size_t p = 0; p < mostrados; ++p) {
+        // Con mas de 10 puntos se muestran 10 repartidos a lo largo del frente
+        size_t k = mostrados > 1 ? p * (archivo.tamano() - 1) / (mostrados - 1) : 0;
+        const Objetivos& o = archivo.objetivos(k);
+        cout << fixed << setprecision(4) << setw(14) << o.cosecha << setw(14) << o.agua << setw(14) << o.salinidad << endl;
+    }
+    if (!opciones.guardarFrente.empty()) {
+        try {
+            archivo.guardar(opciones.guardarFrente);
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+    return guardarSolucion(opciones, mejorCosecha, numeroCultivos, meses) ? 0 : 1;
+}
+
+// Modelo de islas en varios procesos: este proceso coordina y cada trabajador ejecuta una isla
+// de --luciernagas luciernagas. Los trabajadores se lanzan con este mismo ejecutable salvo con
+// --sin-lanzar, en cuyo caso se esperan los que se conecten a --socket.
+int resolverDistribuido(const Opciones& opciones, const char* argv0, const Instancia& instancia) {
+#ifdef ALGORITMOFA_SOCKETS_UNIX
+    ConfiguracionDistribuida configuracion;
+    configuracion.semilla = opciones.semilla;
+    configuracion.luciernagas = opciones.luciernagas;
+    configuracion.iteraciones = opciones.iteraciones;
+    configuracion.intervaloMigracion = opciones.intervaloMigracion;
+    configuracion.migrantes = opciones.migrantes;
+    configuracion.combinada = opciones.combinada;
+    string ruta = opciones.rutaSocket.empty() ? "/tmp/algoritmofa-" + to_string(getpid()) + ".sock" : opciones.rutaSocket;
+    string ejecutable = opciones.sinLanzar ? string() : Coordinador::rutaEjecutable(argv0);
+    if (opciones.sinLanzar) cerr << "Esperando " << opciones.distribuido << " trabajadores en " << ruta << endl;
+
+    // El coordinador no ve los enjambres, asi que no puede medir su diversidad
+    CriteriosParada criterios = criteriosParada(opciones);
+    criterios.diversidadMinima = 0.0;
+
+    Coordinador coordinador;
+    try {
+        coordinador.ejecutar(opciones.distribuido, ruta, ejecutable, configuracion, instancia, criterios);
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    imprimirParada(coordinador.motivo, coordinador.iteracionesHechas);
+    imprimirResultado(coordinador.mejorLuciernaga, instancia.numeroCultivos, instancia.meses, instancia.cultivacion,
+                      coordinador.evaluaciones);
+    return guardarSolucion(opciones, coordinador.mejorLuciernaga, instancia.numeroCultivos, instancia.meses) ? 0 : 1;
+#else
+    (void)opciones;
+    (void)argv0;
+    (void)instancia;
+    cerr << "El modo distribuido necesita sockets Unix" << endl;
+    return 1;
+#endif
+}
+
+int resolverComoTrabajador(const Opciones& opciones) {
+#ifdef ALGORITMOFA_SOCKETS_UNIX
+    try {
+        Trabajador::ejecutar(opciones.trabajador, opciones.idTrabajador);
+    } catch (const runtime_error& e) {
+        cerr << "Trabajador " << opciones.idTrabajador << ": " << e.what() << endl;
+        return 1;
+    }
     return 0;
+#else
+    (void)opciones;
+    cerr << "El modo distribuido necesita sockets Unix" << endl;
+    return 1;
+#endif
+}
+
+// Servicio por lotes: las instancias de --lote (o de la entrada estandar con '-') se resuelven a la
+// vez, una por hilo de --hilos, y cada resultado sale por la salida estandar como una linea JSON
+int resolverLote(const Opciones& opciones) {
+    ConfiguracionLotes configuracion;
+    configuracion.hilos = opciones.hilos;
+    configuracion.semilla = opciones.semilla;
+    configuracion.luciernagas = opciones.luciernagas;
+    configuracion.sincrono = opciones.sincrono;
+    configuracion.combinada = opciones.combinada;
+    configuracion.contiguo = opciones.contiguo;
+    configuracion.inicializacionRechazo = opciones.inicializacionRechazo;
+    configuracion.vecinos = opciones.vecinos;
+    configuracion.umbralAtractivo = opciones.umbralAtractivo;
+    configuracion.repararFactibilidad = opciones.reparar;
+    configuracion.criterios = criteriosParada(opciones);
+    configuracion.pendientesMaximos = max<size_t>(64, 4 * static_cast<size_t>(opciones.hilos));
+
+    ServicioLotes servicio(configuracion);
+    if (opciones.lote == "-") return servicio.ejecutar(cin) == 0 ? 0 : 1;
+    ifstream archivo(opciones.lote.c_str());
+    if (!archivo) {
+        cerr << "No se puede abrir el lote '" << opciones.lote << "'" << endl;
+        return 1;
+    }
+    return servicio.ejecutar(archivo) == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    Opciones opciones = leerOpciones(argc, argv);
+    if (opciones.invalidas) return 1;
+    if (opciones.simd == "escalar")
+        KernelsSimd::fijarNivel(KernelsSimd::ESCALAR);
+    else if (opciones.simd == "avx2")
+        KernelsSimd::fijarNivel(KernelsSimd::AVX2);
+    else if (opciones.simd == "avx512")
+        KernelsSimd::fijarNivel(KernelsSimd::AVX512);
+    if (!opciones.trabajador.empty()) return resolverComoTrabajador(opciones);
+    if (!opciones.lote.empty()) {
+        // ConfiguracionLotes solo lleva los parametros del enjambre y los criterios de parada
+        vector<string> ignoradas;
+        if (!opciones.instancia.empty()) ignoradas.push_back("--instancia");
+        if (opciones.cultivosGenerados > 0) ignoradas.push_back("--generar");
+        if (!opciones.guardarInstancia.empty()) ignoradas.push_back("--guardar-instancia");
+        if (opciones.entradasCache > 0) ignoradas.push_back("--cache");
+        if (opciones.islas > 1) ignoradas.push_back("--islas");
+        if (opciones.distribuido > 0) ignoradas.push_back("--distribuido");
+        if (opciones.multiobjetivo) ignoradas.push_back("--multiobjetivo");
+        if (!opciones.arranque.empty()) ignoradas.push_back("--arranque");
+        if (!opciones.puntoControl.empty()) ignoradas.push_back("--punto-control");
+        if (!opciones.reanudar.empty()) ignoradas.push_back("--reanudar");
+        if (!opciones.telemetria.empty()) ignoradas.push_back("--telemetria");
+        if (!opciones.guardarSolucion.empty()) ignoradas.push_back("--guardar-solucion");
+        if (!opciones.guardarFrente.empty()) ignoradas.push_back("--guardar-frente");
+        if (!ignoradas.empty()) {
+            cerr << "Aviso: en modo lote se ignoran";
+            for (size_t k = 0; k < ignoradas.size(); ++k) cerr << (k == 0 ? " " : ", ") << ignoradas[k];
+            cerr << endl;
+        }
+        return resolverLote(opciones);
+    }
+
+    int numLuciernagas = opciones.luciernagas;  // Numero de luciernagas
+    int iteraciones = opciones.iteraciones;     // Numero de iteraciones
+
+    // Sin --instancia ni --generar se resuelve el ejemplo de Cultivacion (5 cultivos x 8 meses)
+    Instancia instancia;
+    try {
+        if (!opciones.instancia.empty())
+            instancia = Instancia::cargar(opciones.instancia);
+        else if (opciones.cultivosGenerados > 0)
+            instancia = Instancia::generar(opciones.cultivosGenerados, opciones.mesesGenerados, opciones.semilla);
+        if (!opciones.guardarInstancia.empty()) instancia.guardar(opciones.guardarInstancia);
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    int meses = instancia.meses;                     // Numero de meses
+    int numeroCultivos = instancia.numeroCultivos;   // Numero de cultivos
+    int dimension = instancia.dimension();           // Dimension total
+
+    Cultivacion& cultivacion = instancia.cultivacion;
+    bool variosEnjambres = opciones.distribuido > 0 || opciones.islas > 1;
+    if (!opciones.arranque.empty() && variosEnjambres) {
+        cerr << "Aviso: --arranque solo se aplica con un unico enjambre; se ignora" << endl;
+    }
+    if (opciones.reparar && variosEnjambres) {
+        cerr << "Aviso: --reparar solo se aplica con un unico enjambre; se ignora" << endl;
+    }
+    if (opciones.entradasCache > 0 && variosEnjambres) {
+        cerr << "Aviso: --cache solo se aplica con un unico enjambre; se ignora" << endl;
+    }
+    if (opciones.islas > 1 && opciones.distribuido == 0 && !opciones.multiobjetivo &&
+        (!opciones.puntoControl.empty() || !opciones.reanudar.empty() || !opciones.telemetria.empty())) {
+        cerr << "Aviso: --punto-control, --reanudar y --telemetria no se aplican al modelo de islas; se ignoran" << endl;
+    }
+    if (opciones.multiobjetivo) {
+        if (variosEnjambres || opciones.sincrono || opciones.combinada || opciones.vecinos > 0 || !opciones.arranque.empty() ||
+            opciones.entradasCache > 0 || !opciones.reanudar.empty() || !opciones.puntoControl.empty() ||
+            !opciones.telemetria.empty()) {
+            cerr << "Aviso: --multiobjetivo solo tiene iteracion secuencial con un unico enjambre; se ignoran --islas, "
+                    "--distribuido, --modo, --actualizacion, --vecinos, --arranque, --cache, --reanudar, --punto-control "
+                    "y --telemetria"
+                 << endl;
+        }
+        return resolverMultiobjetivo(opciones, numeroCultivos, meses, cultivacion);
+    }
+    if (opciones.distribuido > 0) {
+        if (opciones.topologiaAleatoria || opciones.variarParametros || opciones.vecinos > 0 || opciones.sincrono ||
+            opciones.umbralAtractivo > 0 || opciones.inicializacionRechazo || opciones.contiguo ||
+            opciones.diversidadMinima > 0 || !opciones.puntoControl.empty() || !opciones.reanudar.empty() ||
+            !opciones.telemetria.empty()) {
+            cerr << "Aviso: en modo distribuido se ignoran --topologia aleatoria, --variar-parametros, --vecinos, "
+                    "--modo sincrono, --umbral-atractivo, --inicializacion rechazo, --contiguo, --diversidad-minima, "
+                    "--punto-control, --reanudar y --telemetria"
+                 << endl;
+        }
+        return resolverDistribuido(opciones, argv[0], instancia);
+    }
+    if (opciones.islas > 1) return resolverConIslas(opciones, numeroCultivos, meses, cultivacion);
+
+    // Soluciones previas para el arranque en caliente; con --reanudar manda el punto de control
+    vector<Luciernaga> previas;
+    if (!opciones.arranque.empty() && opciones.reanudar.empty()) {
+        try {
+            previas = ArranqueCaliente::cargar(opciones.arranque, numeroCultivos, meses);
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+
+    CriteriosParada criterios = criteriosParada(opciones);
+    Enjambre enjambre(numLuciernagas, dimension, opciones.semilla);
+    // Al reanudar, el enjambre, sus parametros y el modo de iteracion salen del punto de control
+    int primeraIteracion = 0;
+    PuntoControl reanudado;
+    if (!opciones.reanudar.empty()) {
+        try {
+            reanudado = PuntoControl::cargar(opciones.reanudar, enjambre, instancia);
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        primeraIteracion = reanudado.iteracion;
+        opciones.sincrono = reanudado.sincrono;
+        opciones.combinada = enjambre.modoActualizacion == ACTUALIZACION_COMBINADA;
+    }
+
+    // La cache no va en el punto de control: al reanudar empieza vacia
+    unique_ptr<CacheEvaluaciones> cache;
+    if (opciones.entradasCache > 0) {
+        cache.reset(new CacheEvaluaciones(opciones.entradasCache, opciones.resolucionCache));
+        enjambre.cacheEvaluaciones = cache.get();
+    }
+
+    // La actualizacion combinada tambien trabaja sobre la generacion anterior y puede usar hilos
+    bool paralelo = opciones.sincrono || opciones.combinada;
+    PoolHilos pool(paralelo ? opciones.hilos : 1);
+
+    if (opciones.reanudar.empty()) {
+        if (opciones.inicializacionRechazo) enjambre.estrategiaInicializacion = INICIALIZACION_RECHAZO;
+        if (opciones.vecinos > 0) {
+            enjambre.modoAtraccion = ATRACCION_VECINOS;
+            enjambre.vecinosAtraccion = opciones.vecinos;
+        }
+        enjambre.umbralAtractivo = opciones.umbralAtractivo;
+        enjambre.repararFactibilidad = opciones.reparar;
+        if (opciones.combinada) enjambre.modoActualizacion = ACTUALIZACION_COMBINADA;
+
+        if (paralelo)
+            enjambre.inicializarLuciernagas(numeroCultivos, meses, cultivacion, pool);
+        else
+            enjambre.inicializarLuciernagas(numeroCultivos, meses, cultivacion);
+        if (!previas.empty()) {
+            size_t sembradas = static_cast<size_t>(ceil(opciones.fraccionArranque * numLuciernagas));
+            enjambre.sembrarLuciernagas(previas, sembradas, numeroCultivos, meses, cultivacion);
+        }
+        if (paralelo)
+            enjambre.inicializarValoresObjetivo(numeroCultivos, meses, cultivacion, pool);
+        else
+            enjambre.inicializarValoresObjetivo(numeroCultivos, meses, cultivacion);
+        if (opciones.contiguo) enjambre.activarAlmacenamientoContiguo();
+    }
+
+    Luciernaga mejorLuciernaga = opciones.reanudar.empty() ? enjambre.encontrarMejorLuciernaga() : reanudado.mejorLuciernaga;
+    double mejorValor = mejorLuciernaga.valorObjetivo;
+    unsigned long asignacionesTrasPrimeraIteracion = 0;
+    vector<uint8_t> memoriaPuntoControl;
+
+    unique_ptr<Telemetria> telemetria;
+    if (!opciones.telemetria.empty()) {
+        try {
+            telemetria.reset(new Telemetria(opciones.telemetria, opciones.telemetriaCsv ? TELEMETRIA_CSV : TELEMETRIA_NDJSON));
+            telemetria->partirDe(enjambre);
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+    typedef chrono::steady_clock Reloj;
+    Reloj::time_point inicioFase;
+    RegistroIteracion registro;
+    Luciernaga centroide(0);
+
+    criterios.iniciar(primeraIteracion, mejorValor);
+    MotivoParada motivo = primeraIteracion < iteraciones ? PARADA_NINGUNA : PARADA_ITERACIONES;
+    int iter = primeraIteracion;
+
+    // La iteracion secuencial de las formas habituales va por la version especializada, salvo si
+    // hay que mirar dentro del enjambre en cada iteracion (telemetria, puntos de control)
+    if (motivo == PARADA_NINGUNA && !paralelo && !opciones.formaDinamica && !telemetria && opciones.puntoControl.empty()) {
+        IteracionFija fija(enjambre, criterios, mejorLuciernaga, centroide, primeraIteracion);
+        if (despacharFormaFija(numeroCultivos, meses, fija)) {
+            motivo = fija.motivo;
+            iter = fija.iteracion;
+            asignacionesTrasPrimeraIteracion = fija.asignacionesTrasPrimeraIteracion;
+        }
+    }
+    for (; motivo == PARADA_NINGUNA; ++iter) {
+        if (telemetria) inicioFase = Reloj::now();
+        if (opciones.combinada)
+            enjambre.iterarCombinado(numeroCultivos, meses, cultivacion, pool, iter);
+        else if (opciones.sincrono)
+            enjambre.iterarSincrono(numeroCultivos, meses, cultivacion, pool, iter);
+        else
+            enjambre.iterarSecuencial(numeroCultivos, meses, cultivacion);
+        if (telemetria) {
+            Reloj::time_point finFase = Reloj::now();
+            registro.segundosIteracion = chrono::duration<double>(finFase - inicioFase).count();
+            inicioFase = finFase;
+        }
+
+        size_t indiceMejor = enjambre.indiceMejorLuciernaga();
+        if (enjambre.valoresObjetivo[indiceMejor] > mejorValor) {
+            enjambre.copiarLuciernaga(indiceMejor, mejorLuciernaga);
+            mejorValor = mejorLuciernaga.valorObjetivo;
+        }
+        if (telemetria) {
+            telemetria->medir(enjambre, iter, registro);
+            Reloj::time_point finFase = Reloj::now();
+            registro.segundosMedicion = chrono::duration<double>(finFase - inicioFase).count();
+            inicioFase = finFase;
+        }
+        motivo = criterios.comprobar(iter + 1, mejorValor, enjambre.evaluaciones(), [&]() {
+            return telemetria ? registro.diversidad : enjambre.calcularDiversidad(centroide);
+        });
+        if (!opciones.puntoControl.empty() && ((iter + 1) % opciones.intervaloPuntoControl == 0 || motivo != PARADA_NINGUNA)) {
+            try {
+                PuntoControl::guardar(opciones.puntoControl, enjambre, instancia, iter + 1, opciones.sincrono, mejorLuciernaga,
+                                      memoriaPuntoControl);
+            } catch (const runtime_error& e) {
+                cerr << e.what() << endl;
+                return 1;
+            }
+        }
+        if (telemetria) {
+            registro.segundosPuntoControl = chrono::duration<double>(Reloj::now() - inicioFase).count();
+            telemetria->publicar(registro);
+        }
+        // La primera iteracion dimensiona los espacios de trabajo; las siguientes no deberian pedir memoria
+        if (iter == primeraIteracion) asignacionesTrasPrimeraIteracion = ContadorAsignaciones::total();
+    }
+    if (telemetria) telemetria->terminar();
+    if (ContadorAsignaciones::activo()) {
+        cerr << "Reservas de memoria despues de la primera iteracion: "
+             << ContadorAsignaciones::total() - asignacionesTrasPrimeraIteracion << endl;
+    }
+    imprimirParada(motivo, iter);
+    imprimirResultado(mejorLuciernaga, numeroCultivos, meses, cultivacion, enjambre.evaluaciones());
+    if (cache) {
+        CacheEvaluaciones::Estadisticas estadisticas = cache->estadisticas();
+        cout << "Cache de evaluaciones: " << estadisticas.aciertos << " aciertos, " << estadisticas.fallos << " fallos ("
+             << fixed << setprecision(1) << 100.0 * estadisticas.tasaAciertos() << "%), " << estadisticas.reemplazos
+             << " reemplazos" << endl;
+    }
+    return guardarSolucion(opciones, mejorLuciernaga, numeroCultivos, meses) ? 0 : 1;
 }